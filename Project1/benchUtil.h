@@ -0,0 +1,39 @@
+#ifndef _BENCH_UTIL_H
+#define _BENCH_UTIL_H
+
+//
+// Word sources shared by the benchmarks.
+//
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+// Read the lowercased lines of a dictionary file
+inline std::vector<std::string> readDictionary(const std::string &file) {
+    std::ifstream input(file);
+    std::vector<std::string> words;
+    std::string word;
+    while (getline(input, word)) {
+        std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+        words.push_back(word);
+    }
+    return words;
+}
+
+// Generate random lowercase words
+inline std::vector<std::string> randomWords(int count, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> length(3, 14), letter('a', 'z');
+    std::vector<std::string> words(count);
+    for (auto &word : words) {
+        int n = length(rng);
+        for (int i = 0; i < n; i++) {
+            word += static_cast<char>(letter(rng));
+        }
+    }
+    return words;
+}
+
+#endif //_BENCH_UTIL_H
@@ -0,0 +1,96 @@
+//
+// Benchmark for the Bloom filter in front of the spellcheck dictionary.
+//
+// Loads the dictionary into a hashTable, then times lookups of known
+// words, unknown words, and a mix of 95% known words, first against the
+// plain table and then through Bloom filters of several sizes. For each
+// filter it also reports its memory and its measured false-positive
+// rate on the unknown words.
+//
+// Usage: bloomBench.exe [dictionary]
+// Without a dictionary, random words are generated.
+//
+
+#include "hash.h"
+#include "bloomFilter.h"
+#include "benchUtil.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+// A named stream of words to look up
+struct lookupSet {
+    std::string name;
+    std::vector<std::string> words;
+};
+
+// Time contains over every lookup set
+template <typename F>
+static void runLookups(const std::vector<lookupSet> &lookups, F contains) {
+    for (const auto &set : lookups) {
+        long found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &word : set.words) {
+            found += contains(word);
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << set.name << ": " << 1e9 * secs / set.words.size() << " ns/lookup, "
+                  << found << " found" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::mt19937 rng(12345);
+    std::vector<std::string> dictionary = argc > 1 ? readDictionary(argv[1]) : randomWords(500000, rng);
+    hashTable table(0);
+    for (const auto &word : dictionary) {
+        table.insert(word);
+    }
+
+    // Unknown words are dictionary words with one letter changed
+    const int LOOKUPS = 2000000;
+    std::uniform_int_distribution<size_t> pick(0, dictionary.size() - 1);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> hits, misses, mixed;
+    while (static_cast<int>(hits.size()) < LOOKUPS) {
+        hits.push_back(dictionary[pick(rng)]);
+    }
+    while (static_cast<int>(misses.size()) < LOOKUPS) {
+        std::string word = dictionary[pick(rng)];
+        if (word.empty()) {
+            continue;
+        }
+        word[std::uniform_int_distribution<size_t>(0, word.size() - 1)(rng)] = static_cast<char>(letter(rng));
+        if (!table.contains(word)) {
+            misses.push_back(word);
+        }
+    }
+    for (int i = 0; i < LOOKUPS; i++) {
+        mixed.push_back(i % 20 == 0 ? misses[i] : hits[i]);
+    }
+    std::vector<lookupSet> lookups = {{"known", hits}, {"unknown", misses}, {"95% known", mixed}};
+
+    std::cout << dictionary.size() << " dictionary words" << std::endl;
+    std::cout << "plain table" << std::endl;
+    runLookups(lookups, [&](const std::string &word) { return table.contains(word); });
+
+    for (double rate : {0.1, 0.01, 0.001}) {
+        bloomFilter filter(table.size(), rate);
+        table.forEach([&filter](std::string_view key, void *) { filter.insert(key); });
+        long falsePositives = 0;
+        for (const auto &word : misses) {
+            falsePositives += filter.mayContain(word);
+        }
+        std::cout << "Bloom filter, target rate " << rate << ": " << filter.memoryBytes() << " bytes ("
+                  << 8.0 * filter.memoryBytes() / table.size() << " bits/word), "
+                  << filter.hashCount() << " hashes, measured rate "
+                  << static_cast<double>(falsePositives) / misses.size() << std::endl;
+        runLookups(lookups, [&](const std::string &word) {
+            return filter.mayContain(word) && table.contains(word);
+        });
+    }
+    return 0;
+}
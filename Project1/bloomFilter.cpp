@@ -0,0 +1,72 @@
+#include "bloomFilter.h"
+#include "hashFunctions.h"
+
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Size the filter from the target false-positive rate or the bits per key
+bloomFilter::bloomFilter(int expectedKeys, double falsePositiveRate, double bitsPerKey) {
+    const double ln2 = std::log(2.0);
+    if (bitsPerKey > 0) {
+        // The best number of hashes for a given memory
+        numHashes = static_cast<int>(std::lround(bitsPerKey * ln2));
+    } else {
+        falsePositiveRate = std::min(std::max(falsePositiveRate, 1e-9), 0.5);
+        bitsPerKey = -std::log(falsePositiveRate) / (ln2 * ln2);
+        numHashes = static_cast<int>(std::lround(-std::log2(falsePositiveRate)));
+    }
+    numHashes = std::min(std::max(numHashes, 1), MAX_HASHES);
+    double bits = bitsPerKey * std::max(expectedKeys, 1);
+    size_t numBlocks = static_cast<size_t>(std::ceil(bits / BLOCK_BITS));
+    blocks.assign(std::max<size_t>(numBlocks, 1), block{});
+}
+
+// Pick a block with the high half of the hash value, and the bits with
+// a second, independent hash (double hashing within the block)
+size_t bloomFilter::locate(uint64_t hashVal, block &mask) const {
+    size_t index = ((hashVal >> 32) * blocks.size()) >> 32;
+    uint64_t bitHash = hashAvalanche(hashVal);
+    uint32_t a = static_cast<uint32_t>(bitHash);
+    uint32_t b = static_cast<uint32_t>(bitHash >> 32) | 1;
+    mask = block{};
+    for (int i = 0; i < numHashes; i++) {
+        // The top 9 bits choose one of the block's 512 bits
+        unsigned int bit = (a + i * b) >> 23;
+        mask.words[bit >> 6] |= static_cast<uint64_t>(1) << (bit & 63);
+    }
+    return index;
+}
+
+// Set the key's bits in its block
+void bloomFilter::insert(std::string_view key) {
+    block mask;
+    block &b = blocks[locate(hashWyhash(key.data(), key.size()), mask)];
+    for (int i = 0; i < 8; i++) {
+        b.words[i] |= mask.words[i];
+    }
+}
+
+// Check that every bit of the key's mask is set in its block
+bool bloomFilter::mayContain(std::string_view key) const {
+    block mask;
+    const block &b = blocks[locate(hashWyhash(key.data(), key.size()), mask)];
+#ifdef __SSE2__
+    // Collect the mask bits missing from the block, 16 bytes at a time
+    __m128i missing = _mm_setzero_si128();
+    for (int i = 0; i < 8; i += 2) {
+        __m128i m = _mm_load_si128(reinterpret_cast<const __m128i *>(&mask.words[i]));
+        __m128i bits = _mm_load_si128(reinterpret_cast<const __m128i *>(&b.words[i]));
+        missing = _mm_or_si128(missing, _mm_andnot_si128(bits, m));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xFFFF;
+#else
+    uint64_t missing = 0;
+    for (int i = 0; i < 8; i++) {
+        missing |= mask.words[i] & ~b.words[i];
+    }
+    return missing == 0;
+#endif
+}
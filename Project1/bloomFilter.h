@@ -0,0 +1,63 @@
+#ifndef _BLOOM_FILTER_H
+#define _BLOOM_FILTER_H
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+//
+// bloomFilter - a blocked Bloom filter over strings.
+//
+// Every key maps to one 64-byte block (one cache line) and sets
+// hashCount bits inside it, so a check touches a single cache line.
+// The bits a key needs are gathered into a 64-byte mask first, and the
+// mask is compared with the block 16 bytes at a time with SSE2.
+//
+// mayContain never returns false for a key that was inserted; for
+// other keys it returns true with about the chosen false-positive
+// rate. Putting a filter in front of a dictionary lets most misspelled
+// words be rejected without probing the dictionary.
+//
+class bloomFilter {
+
+ public:
+
+  // The constructor sizes the filter for the specified number of keys.
+  // By default the memory follows from the target false-positive rate;
+  // if bitsPerKey is positive it sets the memory instead, and the
+  // false-positive rate follows from it.
+  bloomFilter(int expectedKeys = 0, double falsePositiveRate = 0.01, double bitsPerKey = 0);
+
+  // Add a key to the filter.
+  void insert(std::string_view key);
+
+  // Check if the key may have been inserted.
+  // Returns false only if it certainly was not.
+  bool mayContain(std::string_view key) const;
+
+  // The number of bytes of filter memory.
+  size_t memoryBytes() const { return blocks.size() * sizeof(block); }
+
+  // The number of bits each key sets.
+  int hashCount() const { return numHashes; }
+
+ private:
+
+  // One cache line of filter bits.
+  struct alignas(64) block {
+    uint64_t words[8];
+  };
+
+  static constexpr int BLOCK_BITS = 512;
+  static constexpr int MAX_HASHES = 16;
+
+  std::vector<block> blocks;
+  int numHashes;
+
+  // Return the block for a hash value, and set in mask the bits the
+  // key needs within it.
+  size_t locate(uint64_t hashVal, block &mask) const;
+};
+
+#endif //_BLOOM_FILTER_H
@@ -0,0 +1,140 @@
+//
+// Benchmark for concurrentHashTable.
+//
+// Loads the dictionary (or random words), then runs three operation
+// mixes on 1 to 64 threads: lookups only, 90% lookups with 10% writes,
+// and 50% of each. Half of the lookups are of dictionary words and
+// half of misspelled ones; the writes insert new keys and remove keys
+// the same thread inserted before. Each mix is run against
+// concurrentHashTable and, for comparison, against a hashTable behind
+// a std::shared_mutex (lookups share the lock, writes take it alone).
+// Throughput is in millions of operations per second over all threads.
+//
+// concurrentHashTable never reuses the memory of a removed entry until
+// the table is destroyed, so the write mixes here grow its memory with
+// every insert even though the number of keys stays about the same; a
+// workload that churns through new keys for long needs a fresh table
+// now and then. Threads beyond MAX_THREADS (256) do not block, but
+// while any of them is looking up, slot arrays replaced by growth are
+// not freed.
+//
+// Usage: concurrentBench.exe [dictionary]
+// Without a dictionary, random words are generated.
+//
+
+#include "hash.h"
+#include "concurrentHash.h"
+#include "benchUtil.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <shared_mutex>
+
+// A hashTable behind a reader-writer lock
+struct lockedTable {
+    hashTable table;
+    std::shared_mutex lock;
+
+    int insert(std::string_view key) {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        return table.insert(key);
+    }
+
+    bool remove(std::string_view key) {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        return table.remove(key);
+    }
+
+    // A lookup never changes the table, so lookups can share the lock
+    bool contains(std::string_view key) {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return table.contains(key);
+    }
+};
+
+// One thread's operations: lookups, and the keys it inserts and removes
+struct threadWork {
+    std::vector<std::string> lookups;
+    std::vector<std::string> inserts;
+};
+
+// Run writePercent% writes and lookups otherwise on every thread
+// Returns millions of operations per second
+template <typename Table>
+static double runMix(Table &table, const std::vector<threadWork> &work, int writePercent) {
+    auto worker = [&](const threadWork &w) {
+        size_t nextLookup = 0, nextInsert = 0, nextRemove = 0;
+        long found = 0;
+        for (size_t op = 0; op < w.lookups.size(); op++) {
+            if (static_cast<int>(op % 100) < writePercent) {
+                // Alternate between inserting a new key and removing an old one
+                if (op % 2 == 0 || nextRemove == nextInsert) {
+                    table.insert(w.inserts[nextInsert++ % w.inserts.size()]);
+                } else {
+                    table.remove(w.inserts[nextRemove++ % w.inserts.size()]);
+                }
+            } else {
+                found += table.contains(w.lookups[nextLookup++]);
+            }
+        }
+        return found;
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (const auto &w : work) {
+        threads.emplace_back(worker, std::cref(w));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t ops = 0;
+    for (const auto &w : work) {
+        ops += w.lookups.size();
+    }
+    return ops / secs / 1e6;
+}
+
+int main(int argc, char **argv) {
+    std::mt19937 rng(12345);
+    std::vector<std::string> dictionary = argc > 1 ? readDictionary(argv[1]) : randomWords(500000, rng);
+    const int TOTAL_OPS = 4000000;
+    std::cout << dictionary.size() << " dictionary words, " << TOTAL_OPS << " operations per run" << std::endl;
+    std::cout << "threads, mix, concurrentHashTable Mops/s, locked hashTable Mops/s" << std::endl;
+
+    std::uniform_int_distribution<size_t> pick(0, dictionary.size() - 1);
+    for (int numThreads : {1, 2, 4, 8, 16, 32, 64}) {
+        // Split the operations between the threads; each inserts its own keys
+        std::vector<threadWork> work(numThreads);
+        for (int t = 0; t < numThreads; t++) {
+            int ops = TOTAL_OPS / numThreads;
+            for (int i = 0; i < ops; i++) {
+                std::string word = dictionary[pick(rng)];
+                if (i % 2) {
+                    word += '#';
+                }
+                work[t].lookups.push_back(word);
+            }
+            for (int i = 0; i < ops / 10 + 1; i++) {
+                work[t].inserts.push_back("t" + std::to_string(t) + "-" + std::to_string(i));
+            }
+        }
+        for (int writePercent : {0, 10, 50}) {
+            concurrentHashTable shared(dictionary.size());
+            lockedTable locked;
+            for (const auto &word : dictionary) {
+                shared.insert(word);
+                locked.table.insert(word);
+            }
+            double concurrentRate = runMix(shared, work, writePercent);
+            double lockedRate = runMix(locked, work, writePercent);
+            std::cout << numThreads << ", " << 100 - writePercent << "/" << writePercent << ", "
+                      << concurrentRate << ", " << lockedRate << std::endl;
+        }
+    }
+    return 0;
+}
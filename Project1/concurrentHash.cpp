@@ -0,0 +1,313 @@
+#include "concurrentHash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+static_assert(sizeof(uintptr_t) == 8, "slots keep a hash tag in the top 16 bits of 64-bit pointers");
+
+// Which reader indexes are taken by live threads
+static std::atomic<bool> indexTaken[concurrentHashTable::MAX_THREADS];
+
+// A thread's reader index, taken on its first lookup and given back when it exits
+// If every index is taken, the thread goes without one rather than waiting
+struct readerIndex {
+    int index {-1};
+
+    readerIndex() {
+        for (int i = 0; i < concurrentHashTable::MAX_THREADS; i++) {
+            if (!indexTaken[i].load(std::memory_order_relaxed) && !indexTaken[i].exchange(true)) {
+                index = i;
+                return;
+            }
+        }
+    }
+
+    ~readerIndex() {
+        if (index != -1) {
+            indexTaken[index].store(false);
+        }
+    }
+};
+
+int concurrentHashTable::threadIndex() {
+    static thread_local readerIndex mine;
+    return mine.index;
+}
+
+// Publish the epoch (or, without a reader index, count the lookup)
+// before loading the slot array, so a writer that retires the array
+// afterwards sees that this lookup may be reading it
+concurrentHashTable::readGuard::readGuard(concurrentHashTable &table) : table(table), epoch(nullptr) {
+    int index = threadIndex();
+    if (index != -1) {
+        epoch = &table.readers[index].epoch;
+        epoch->store(table.globalEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    } else {
+        table.overflowReaders.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+concurrentHashTable::readGuard::~readGuard() {
+    if (epoch) {
+        epoch->store(0, std::memory_order_release);
+    } else {
+        table.overflowReaders.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+concurrentHashTable::concurrentHashTable(int size, hashFunction kind) {
+    hashKey = getHashFunction(kind);
+    // Room for size items at a load of one half
+    int capacity = MIN_CAPACITY;
+    while (capacity / 2 < size && capacity < MAX_CAPACITY) {
+        capacity <<= 1;
+    }
+    table *t = new table{capacity, std::unique_ptr<std::atomic<uintptr_t>[]>(new std::atomic<uintptr_t>[capacity]())};
+    current.store(t);
+}
+
+concurrentHashTable::~concurrentHashTable() {
+    delete current.load();
+    for (auto &r : retired) {
+        delete r.first;
+    }
+}
+
+// Linear probing, one slot at a time; the tag rules out most entries
+// without reading them
+int concurrentHashTable::probe(const table *t, std::string_view key, uint64_t hashVal, int *pFree, entry **pFound) {
+    unsigned int mask = t->capacity - 1;
+    uintptr_t tag = tagOf(hashVal);
+    int pos = hashVal & mask;
+    if (pFree) {
+        *pFree = -1;
+    }
+    // The load limit keeps EMPTY slots in every sequence, but bound the
+    // probe anyway so a lookup always finishes
+    for (int n = 0; n < t->capacity; n++, pos = (pos + 1) & mask) {
+        uintptr_t slot = t->slots[pos].load(std::memory_order_acquire);
+        if (slot == EMPTY) {
+            if (pFree && *pFree == -1) {
+                *pFree = pos;
+            }
+            return -1;
+        }
+        if (slot == TOMBSTONE) {
+            if (pFree && *pFree == -1) {
+                *pFree = pos;
+            }
+            continue;
+        }
+        if ((slot & ~POINTER_MASK) == tag) {
+            entry *e = entryOf(slot);
+            if (e->hashVal == hashVal && e->length == key.size() && memcmp(e->key(), key.data(), key.size()) == 0) {
+                if (pFound) {
+                    *pFound = e;
+                }
+                return pos;
+            }
+        }
+    }
+    return -1;
+}
+
+// Bump-allocate the entry and its key bytes, 8-byte aligned
+concurrentHashTable::entry *concurrentHashTable::newEntry(stripe &s, std::string_view key, uint64_t hashVal, void *pv) {
+    size_t bytes = (sizeof(entry) + key.size() + 7) & ~static_cast<size_t>(7);
+    try {
+        if (s.chunkUsed + bytes > CHUNK_SIZE) {
+            s.chunks.emplace_back(new char[std::max(bytes, CHUNK_SIZE)]);
+            s.chunkUsed = 0;
+        }
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+    char *p = s.chunks.back().get() + s.chunkUsed;
+    // A key too long for a chunk gets a chunk of its own, and the next
+    // entry starts a new one
+    s.chunkUsed = bytes > CHUNK_SIZE ? CHUNK_SIZE : s.chunkUsed + bytes;
+    entry *e = new (p) entry;
+    e->hashVal = hashVal;
+    e->pv.store(pv, std::memory_order_relaxed);
+    e->length = key.size();
+    memcpy(p + sizeof(entry), key.data(), key.size());
+    return e;
+}
+
+// Inserts a key value pair into the hash table
+int concurrentHashTable::insert(std::string_view key, void *pv) {
+    uint64_t hashVal = hashKey(key.data(), key.size());
+    stripe &s = stripeOf(hashVal);
+    std::unique_lock<std::mutex> lock(s.lock);
+    while (true) {
+        // No other writer of this key can run while the stripe is
+        // locked, and the slot array cannot be replaced
+        table *t = current.load(std::memory_order_acquire);
+        if (used.load(std::memory_order_relaxed) >= t->capacity / 2) {
+            // Growing takes every stripe, this one included
+            lock.unlock();
+            if (!grow(t)) {
+                return 2;
+            }
+            lock.lock();
+            continue;
+        }
+        int freePos;
+        if (probe(t, key, hashVal, &freePos) != -1) {
+            // Return 1 if key already exists
+            return 1;
+        }
+        entry *e = newEntry(s, key, hashVal, pv);
+        if (!e) {
+            return 2;
+        }
+        // Writers of other stripes may claim free slots of this probe
+        // sequence first; move on past any they take
+        uintptr_t packed = reinterpret_cast<uintptr_t>(e) | tagOf(hashVal);
+        unsigned int mask = t->capacity - 1;
+        for (int pos = freePos;; pos = (pos + 1) & mask) {
+            uintptr_t slot = t->slots[pos].load(std::memory_order_relaxed);
+            if ((slot == EMPTY || slot == TOMBSTONE)
+                && t->slots[pos].compare_exchange_strong(slot, packed, std::memory_order_release)) {
+                if (slot == EMPTY) {
+                    used.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+        }
+        filled.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+}
+
+// Check if the hash table contains a key
+bool concurrentHashTable::contains(std::string_view key) {
+    readGuard guard(*this);
+    return probe(current.load(std::memory_order_acquire), key, hashKey(key.data(), key.size())) != -1;
+}
+
+// Get the pointer associated with the specified key
+void *concurrentHashTable::getPointer(std::string_view key, bool *b) {
+    readGuard guard(*this);
+    entry *e;
+    int pos = probe(current.load(std::memory_order_acquire), key, hashKey(key.data(), key.size()), nullptr, &e);
+    if (b != nullptr) {
+        *b = (pos != -1);
+    }
+    if (pos == -1) {
+        return nullptr;
+    }
+    return e->pv.load(std::memory_order_acquire);
+}
+
+// Set the pointer associated with the specified key
+// Entries are shared by every slot array, so the store survives growth
+int concurrentHashTable::setPointer(std::string_view key, void *pv) {
+    readGuard guard(*this);
+    entry *e;
+    int pos = probe(current.load(std::memory_order_acquire), key, hashKey(key.data(), key.size()), nullptr, &e);
+    if (pos == -1) {
+        // Return 1 if key does not exist in the hash table
+        return 1;
+    }
+    e->pv.store(pv, std::memory_order_release);
+    return 0;
+}
+
+// Delete the item with the specified key, leaving a tombstone
+bool concurrentHashTable::remove(std::string_view key) {
+    uint64_t hashVal = hashKey(key.data(), key.size());
+    std::lock_guard<std::mutex> lock(stripeOf(hashVal).lock);
+    table *t = current.load(std::memory_order_acquire);
+    int pos = probe(t, key, hashVal);
+    if (pos == -1) {
+        return false;
+    }
+    t->slots[pos].store(TOMBSTONE, std::memory_order_release);
+    filled.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+int concurrentHashTable::getCapacity() {
+    readGuard guard(*this);
+    return current.load(std::memory_order_acquire)->capacity;
+}
+
+// Copy the entries into a new slot array with room for twice as many
+bool concurrentHashTable::grow(table *seen) {
+    // Lock the stripes in order, so two growing writers cannot deadlock
+    for (auto &s : stripes) {
+        s.lock.lock();
+    }
+    bool ok = true;
+    table *old = current.load(std::memory_order_relaxed);
+    if (old == seen) {
+        int items = filled.load(std::memory_order_relaxed);
+        // Only live entries move, so a table full of tombstones may
+        // come out no larger than it was
+        int capacity = MIN_CAPACITY;
+        while (capacity / 4 < items + 1 && capacity < MAX_CAPACITY) {
+            capacity <<= 1;
+        }
+        table *t = nullptr;
+        try {
+            t = new table{capacity, std::unique_ptr<std::atomic<uintptr_t>[]>(new std::atomic<uintptr_t>[capacity]())};
+        } catch (const std::bad_alloc&) {
+            ok = false;
+        }
+        if (t) {
+            // Nothing else writes while every stripe is locked, and no
+            // lookup sees the new array before it is published
+            unsigned int mask = capacity - 1;
+            for (int i = 0; i < old->capacity; i++) {
+                uintptr_t slot = old->slots[i].load(std::memory_order_relaxed);
+                if (slot != EMPTY && slot != TOMBSTONE) {
+                    int pos = entryOf(slot)->hashVal & mask;
+                    while (t->slots[pos].load(std::memory_order_relaxed) != EMPTY) {
+                        pos = (pos + 1) & mask;
+                    }
+                    t->slots[pos].store(slot, std::memory_order_relaxed);
+                }
+            }
+            used.store(items, std::memory_order_relaxed);
+            current.store(t, std::memory_order_seq_cst);
+        }
+    }
+    for (auto &s : stripes) {
+        s.lock.unlock();
+    }
+    if (ok && old == seen) {
+        retire(old);
+    }
+    return ok;
+}
+
+// Free each retired slot array once every lookup that began before it
+// was retired has finished
+void concurrentHashTable::retire(table *t) {
+    std::lock_guard<std::mutex> lock(retireLock);
+    // Lookups that publish a later epoch load the new slot array
+    uint64_t epoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+    retired.push_back({t, epoch});
+    uint64_t oldestActive = UINT64_MAX;
+    for (auto &r : readers) {
+        uint64_t e = r.epoch.load(std::memory_order_seq_cst);
+        if (e != 0) {
+            oldestActive = std::min(oldestActive, e);
+        }
+    }
+    // A lookup without a reader index may have started in any epoch,
+    // so nothing is freed while one runs; the next retire frees it
+    if (overflowReaders.load(std::memory_order_seq_cst) != 0) {
+        oldestActive = 0;
+    }
+    auto safe = std::partition(retired.begin(), retired.end(), [oldestActive](const std::pair<table *, uint64_t> &r) {
+        return r.second >= oldestActive;
+    });
+    for (auto it = safe; it != retired.end(); ++it) {
+        delete it->first;
+    }
+    retired.erase(safe, retired.end());
+}
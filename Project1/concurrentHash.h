@@ -0,0 +1,198 @@
+#ifndef _CONCURRENT_HASH_H
+#define _CONCURRENT_HASH_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include "hashFunctions.h"
+
+//
+// concurrentHashTable - a hash table that many threads may use at once.
+//
+// Lookups (contains and getPointer) take no lock and never wait: they
+// probe the current slot array with atomic loads, in a bounded number
+// of steps, even while other threads insert, remove or grow the table.
+// setPointer is lock-free in the same way.
+//
+// Writers lock one of NUM_STRIPES stripes, chosen by the key's hash
+// value, so two writers only contend when their keys fall in the same
+// stripe. Writers in different stripes may probe into the same slots;
+// they claim a free slot with a compare-and-swap, so neither loses its
+// item. Growing the table locks every stripe.
+//
+// Each slot is one atomic word: a pointer to an immutable entry (the
+// key, its hash value and its associated pointer) with the top 16
+// bits of the hash value in the pointer's unused high bits, so most
+// mismatches are rejected without touching the entry. Removal leaves
+// a tombstone, because moving entries back would let a concurrent
+// lookup step past its key; growing the table drops the tombstones.
+//
+// Entries are bump-allocated from a per-stripe arena and stay until
+// the table is destroyed, so a removed key's memory is not reused: a
+// workload that keeps inserting and removing new keys grows without
+// limit, however few keys are in the table at once.
+// A slot array replaced by growth is reclaimed with epochs: a lookup
+// publishes the epoch it started in, and the old array is freed only
+// once no lookup that might still be reading it is active.
+//
+// The first MAX_THREADS threads to look up publish their epochs in
+// slots of their own. A thread that finds every slot taken does not
+// wait for one; for the rest of its life its lookups count themselves
+// in a shared counter instead, and while that counter is nonzero no
+// replaced slot array is freed.
+//
+class concurrentHashTable {
+
+ public:
+
+  static constexpr int MAX_THREADS = 256;
+
+  // The constructor initializes the hash table with room for at least
+  // size items before it grows, hashing keys with the given function.
+  concurrentHashTable(int size = 0, hashFunction kind = hashFunction::wyhash);
+  ~concurrentHashTable();
+
+  concurrentHashTable(const concurrentHashTable &) = delete;
+  concurrentHashTable &operator=(const concurrentHashTable &) = delete;
+
+  // Insert the specified key into the hash table.
+  // If an optional pointer is provided,
+  // associate that pointer with the key.
+  // Returns 0 on success,
+  // 1 if key already exists in hash table,
+  // 2 if memory allocation fails.
+  int insert(std::string_view key, void *pv = nullptr);
+
+  // Check if the specified key is in the hash table.
+  // If so, return true; otherwise, return false.
+  bool contains(std::string_view key);
+
+  // Get the pointer associated with the specified key.
+  // If the key does not exist in the hash table, return nullptr.
+  // If an optional pointer to a bool is provided,
+  // set the bool to true if the key is in the hash table,
+  // and set the bool to false otherwise.
+  void *getPointer(std::string_view key, bool *b = nullptr);
+
+  // Set the pointer associated with the specified key.
+  // Returns 0 on success,
+  // 1 if the key does not exist in the hash table.
+  int setPointer(std::string_view key, void *pv);
+
+  // Delete the item with the specified key.
+  // Returns true on success,
+  // false if the specified key is not in the hash table.
+  bool remove(std::string_view key);
+
+  // Return the number of items in the hash table.
+  int size() const { return filled.load(std::memory_order_relaxed); }
+
+  // Return the number of slots in the current slot array.
+  int getCapacity();
+
+ private:
+
+  // A key and its associated pointer; the key's bytes follow it.
+  struct entry {
+    uint64_t hashVal;
+    std::atomic<void *> pv;
+    uint32_t length;
+
+    const char *key() const { return reinterpret_cast<const char *>(this + 1); }
+  };
+
+  // A slot array. A slot is EMPTY, TOMBSTONE, or an entry pointer
+  // tagged with the top bits of its hash value.
+  struct table {
+    int capacity; // A power of two.
+    std::unique_ptr<std::atomic<uintptr_t>[]> slots;
+  };
+
+  static constexpr uintptr_t EMPTY = 0;
+  static constexpr uintptr_t TOMBSTONE = 1;
+  static constexpr int TAG_SHIFT = 48;
+  static constexpr uintptr_t POINTER_MASK = (static_cast<uintptr_t>(1) << TAG_SHIFT) - 1;
+
+  static constexpr int NUM_STRIPES = 64;
+  static constexpr int MIN_CAPACITY = 1024;
+  static constexpr int MAX_CAPACITY = 1 << 30;
+  static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+  // A write lock, and the arena its writers allocate entries from.
+  struct alignas(64) stripe {
+    std::mutex lock;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t chunkUsed {CHUNK_SIZE}; // Bytes used of the last chunk.
+  };
+
+  // The epoch a thread's lookup started in, or 0 outside lookups.
+  // Each is on its own cache line, as every lookup writes it.
+  struct alignas(64) readerEpoch {
+    std::atomic<uint64_t> epoch {0};
+  };
+
+  // Marks the calling thread as reading for as long as it exists.
+  class readGuard {
+   public:
+    explicit readGuard(concurrentHashTable &table);
+    ~readGuard();
+
+   private:
+    concurrentHashTable &table;
+    std::atomic<uint64_t> *epoch; // The thread's slot, or nullptr if it has none.
+  };
+
+  hashFn hashKey;
+  std::atomic<table *> current;
+  std::atomic<int> filled {0}; // Items in the table.
+  std::atomic<int> used {0}; // Slots that are not EMPTY, tombstones included.
+  stripe stripes[NUM_STRIPES];
+  readerEpoch readers[MAX_THREADS];
+
+  // Lookups in progress by threads without a slot in readers.
+  alignas(64) std::atomic<int> overflowReaders {0};
+
+  // Slot arrays replaced by growth, with the epoch they were retired in.
+  std::atomic<uint64_t> globalEpoch {1};
+  std::mutex retireLock;
+  std::vector<std::pair<table *, uint64_t>> retired;
+
+  // The stripe that guards writes of a key.
+  stripe &stripeOf(uint64_t hashVal) { return stripes[(hashVal >> 40) & (NUM_STRIPES - 1)]; }
+
+  static uintptr_t tagOf(uint64_t hashVal) { return (hashVal >> TAG_SHIFT) << TAG_SHIFT; }
+  static entry *entryOf(uintptr_t slot) { return reinterpret_cast<entry *>(slot & POINTER_MASK); }
+
+  // Probe a slot array for the key.
+  // Return the position if found, -1 otherwise.
+  // If pFree is provided and the key is not found, write to that
+  // address the first EMPTY or TOMBSTONE slot of the probe sequence.
+  // If pFound is provided and the key is found, write to that address
+  // its entry, which stays valid even if the slot changes meanwhile.
+  static int probe(const table *t, std::string_view key, uint64_t hashVal, int *pFree = nullptr,
+                   entry **pFound = nullptr);
+
+  // Allocate an entry for the key from the stripe's arena.
+  // Returns nullptr if memory allocation fails.
+  static entry *newEntry(stripe &s, std::string_view key, uint64_t hashVal, void *pv);
+
+  // Replace the slot array seen by a writer with a larger one, unless
+  // another writer already has.
+  // Returns true on success, false if memory allocation fails.
+  bool grow(table *seen);
+
+  // Hand a replaced slot array over to be freed once no lookup can be
+  // reading it, and free any earlier ones that are now safe to free.
+  void retire(table *t);
+
+  // The index of the calling thread into readers, or -1 if every index
+  // was taken when the thread first looked up.
+  static int threadIndex();
+};
+
+#endif //_CONCURRENT_HASH_H
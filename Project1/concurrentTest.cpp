@@ -0,0 +1,203 @@
+//
+// Stress test for concurrentHashTable.
+//
+// Several writer threads each insert, remove, look up and re-point keys
+// of their own at random, checking every result against a serial model
+// of those keys (an std::unordered_map the thread alone uses), while
+// the table grows from its minimum size. All threads also race to insert
+// and remove a small set of shared keys; the number of successful
+// inserts less removes of each must match whether it is left in the
+// table. Reader threads meanwhile look up a set of keys inserted before
+// the test and never removed, which must always be found with their
+// pointers. When the threads are done, every model is checked against
+// the table once more.
+//
+// For a race check, build it with -fsanitize=thread in place of -O2.
+//
+// Usage: concurrentTest.exe [writers] [operations per writer]
+// Prints "ok" and exits with 0, or reports the first mismatch and
+// exits with 1.
+//
+
+#include "concurrentHash.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdlib>
+
+static constexpr int NUM_READERS = 4;
+static constexpr int STABLE_KEYS = 2000;
+static constexpr int SHARED_KEYS = 64;
+static constexpr int OWN_KEYS = 4000;
+
+static std::atomic<bool> failed {false};
+
+// Report a mismatch, once, and make every thread stop.
+static void fail(const std::string &what, const std::string &key) {
+    if (!failed.exchange(true)) {
+        std::cerr << "mismatch: " << what << " \"" << key << "\"\n";
+    }
+}
+
+static void *pointerOf(uintptr_t value) {
+    return reinterpret_cast<void *>(value);
+}
+
+static std::string stableKey(int i) {
+    return "stable-" + std::to_string(i);
+}
+
+static std::string sharedKey(int i) {
+    return "shared-" + std::to_string(i);
+}
+
+// Insert and remove a thread's own keys at random, checking each result
+// against the thread's model; count its wins on the shared keys.
+static void writer(concurrentHashTable &table, int id, int ops,
+                   std::unordered_map<std::string, uintptr_t> &model, std::vector<int> &sharedWins) {
+    std::mt19937 rng(1000 + id);
+    std::uniform_int_distribution<int> pick(0, OWN_KEYS - 1), shared(0, SHARED_KEYS - 1), op(0, 99);
+    std::string prefix = "w" + std::to_string(id) + "-";
+
+    for (int i = 0; i < ops && !failed.load(std::memory_order_relaxed); i++) {
+        int r = op(rng);
+        if (r < 10) {
+            // Race the other writers on a shared key
+            int k = shared(rng);
+            if (r < 5) {
+                int result = table.insert(sharedKey(k));
+                if (result == 2) {
+                    fail("out of memory inserting", sharedKey(k));
+                }
+                sharedWins[k] += (result == 0);
+            } else {
+                sharedWins[k] -= table.remove(sharedKey(k));
+            }
+            continue;
+        }
+
+        std::string key = prefix + std::to_string(pick(rng));
+        auto found = model.find(key);
+        bool present = found != model.end();
+        uintptr_t value = (static_cast<uintptr_t>(id) << 32) | static_cast<uint32_t>(i + 1);
+        if (r < 45) {
+            int result = table.insert(key, pointerOf(value));
+            if (result != (present ? 1 : 0)) {
+                fail("insert returned " + std::to_string(result) + " for", key);
+            }
+            if (!present) {
+                model.emplace(key, value);
+            }
+        } else if (r < 70) {
+            if (table.remove(key) != present) {
+                fail("remove disagreed about", key);
+            }
+            if (present) {
+                model.erase(found);
+            }
+        } else if (r < 80) {
+            if (table.setPointer(key, pointerOf(value)) != (present ? 0 : 1)) {
+                fail("setPointer disagreed about", key);
+            }
+            if (present) {
+                found->second = value;
+            }
+        } else {
+            bool b;
+            void *pv = table.getPointer(key, &b);
+            if (b != present || table.contains(key) != present) {
+                fail("lookup disagreed about", key);
+            } else if (present && pv != pointerOf(found->second)) {
+                fail("wrong pointer for", key);
+            }
+        }
+    }
+}
+
+// Look up the stable keys until the writers are done.
+static void reader(concurrentHashTable &table, int id, const std::atomic<bool> &done) {
+    std::mt19937 rng(2000 + id);
+    std::uniform_int_distribution<int> pick(0, STABLE_KEYS - 1);
+    while (!done.load(std::memory_order_acquire) && !failed.load(std::memory_order_relaxed)) {
+        int k = pick(rng);
+        bool b;
+        void *pv = table.getPointer(stableKey(k), &b);
+        if (!b || pv != pointerOf(k + 1)) {
+            fail("stable key lost", stableKey(k));
+        }
+        // A key no writer ever inserts
+        if (table.contains("missing-" + std::to_string(k))) {
+            fail("found", "missing-" + std::to_string(k));
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int writers = argc > 1 ? atoi(argv[1]) : 8;
+    int ops = argc > 2 ? atoi(argv[2]) : 200000;
+
+    concurrentHashTable table;
+    for (int k = 0; k < STABLE_KEYS; k++) {
+        table.insert(stableKey(k), pointerOf(k + 1));
+    }
+
+    std::vector<std::unordered_map<std::string, uintptr_t>> models(writers);
+    std::vector<std::vector<int>> sharedWins(writers, std::vector<int>(SHARED_KEYS));
+    std::atomic<bool> done {false};
+
+    std::vector<std::thread> readerThreads;
+    for (int id = 0; id < NUM_READERS; id++) {
+        readerThreads.emplace_back(reader, std::ref(table), id, std::cref(done));
+    }
+    std::vector<std::thread> writerThreads;
+    for (int id = 0; id < writers; id++) {
+        writerThreads.emplace_back(writer, std::ref(table), id, ops, std::ref(models[id]),
+                                   std::ref(sharedWins[id]));
+    }
+    for (auto &t : writerThreads) {
+        t.join();
+    }
+    done.store(true, std::memory_order_release);
+    for (auto &t : readerThreads) {
+        t.join();
+    }
+    if (failed) {
+        return 1;
+    }
+
+    // Check the final table against the models
+    int expected = STABLE_KEYS;
+    for (auto &model : models) {
+        for (auto &[key, value] : model) {
+            bool b;
+            if (table.getPointer(key, &b) != pointerOf(value) || !b) {
+                fail("final lookup of", key);
+            }
+        }
+        expected += model.size();
+    }
+    for (int k = 0; k < SHARED_KEYS; k++) {
+        int wins = 0;
+        for (auto &w : sharedWins) {
+            wins += w[k];
+        }
+        if (wins != (table.contains(sharedKey(k)) ? 1 : 0)) {
+            fail("inserts less removes do not match", sharedKey(k));
+        }
+        expected += wins;
+    }
+    if (table.size() != expected) {
+        fail("size " + std::to_string(table.size()) + " is not " + std::to_string(expected) + " after", "the test");
+    }
+    if (failed) {
+        return 1;
+    }
+    std::cout << "ok\n";
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include "dictIndex.h"
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Round an offset up to the next multiple of 8
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+// Lay the dictionary out as a hash table and write it to the file
+bool dictIndex::build(hashTable &dictionary, const std::string &indexFile) {
+    // Keep the load factor at or below one half, as hashTable does by default
+    uint64_t capacity = ctrlGroup::WIDTH;
+    while (capacity < 2 * static_cast<uint64_t>(dictionary.size())) {
+        capacity <<= 1;
+    }
+    std::vector<unsigned char> ctrlBytes(capacity + ctrlGroup::WIDTH - 1, ctrlGroup::EMPTY);
+    std::vector<slot> slotArray(capacity, slot{0, 0});
+    std::string arenaBytes;
+    uint64_t count = 0;
+    bool tooLarge = false;
+    dictionary.forEach([&](std::string_view word, void *) {
+        if (arenaBytes.size() + word.size() > UINT32_MAX) {
+            tooLarge = true;
+            return;
+        }
+        // Linear probing to the first empty slot; words are distinct
+        uint64_t hashVal = hashWyhash(word.data(), word.size());
+        uint64_t pos = hashVal & (capacity - 1);
+        while (ctrlBytes[pos] != ctrlGroup::EMPTY) {
+            pos = (pos + 1) & (capacity - 1);
+        }
+        ctrlBytes[pos] = ctrlGroup::fingerprint(hashVal);
+        if (pos < ctrlGroup::WIDTH - 1) {
+            ctrlBytes[capacity + pos] = ctrlBytes[pos];
+        }
+        slotArray[pos] = slot{static_cast<uint32_t>(arenaBytes.size()), static_cast<uint32_t>(word.size())};
+        arenaBytes += word;
+        count++;
+    });
+    if (tooLarge) {
+        return false;
+    }
+
+    header h;
+    memcpy(h.magic, MAGIC, sizeof(h.magic));
+    h.capacity = capacity;
+    h.count = count;
+    h.ctrlOffset = align8(sizeof(header));
+    h.slotOffset = align8(h.ctrlOffset + ctrlBytes.size());
+    h.arenaOffset = align8(h.slotOffset + capacity * sizeof(slot));
+    h.arenaSize = arenaBytes.size();
+
+    std::ofstream output(indexFile, std::ios::binary | std::ios::trunc);
+    // Write a section, padding the file up to its offset first
+    auto writeAt = [&output](uint64_t offset, const void *data, size_t length) {
+        static const char zeros[8] = {0};
+        output.write(zeros, offset - static_cast<uint64_t>(output.tellp()));
+        output.write(static_cast<const char *>(data), length);
+    };
+    writeAt(0, &h, sizeof(h));
+    writeAt(h.ctrlOffset, ctrlBytes.data(), ctrlBytes.size());
+    writeAt(h.slotOffset, slotArray.data(), capacity * sizeof(slot));
+    writeAt(h.arenaOffset, arenaBytes.data(), arenaBytes.size());
+    return static_cast<bool>(output);
+}
+
+// Check the first bytes of the file against the signature
+bool dictIndex::isIndexFile(const std::string &file) {
+    std::ifstream input(file, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+// Check that length bytes from offset lie within size bytes, without overflow
+static bool fits(uint64_t offset, uint64_t length, uint64_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+// Map the file and check that its sections fit inside it
+bool dictIndex::open(const std::string &indexFile) {
+    close();
+    int fd = ::open(indexFile.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(header)) {
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file alive, so the descriptor can go
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    base = static_cast<const unsigned char *>(p);
+    mappedSize = st.st_size;
+    pHeader = reinterpret_cast<const header *>(base);
+    const header &h = *pHeader;
+    bool valid = memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0
+        && h.capacity >= static_cast<uint64_t>(ctrlGroup::WIDTH) && (h.capacity & (h.capacity - 1)) == 0
+        && h.capacity <= mappedSize
+        && fits(h.ctrlOffset, h.capacity + ctrlGroup::WIDTH - 1, mappedSize)
+        && h.slotOffset % alignof(slot) == 0 && fits(h.slotOffset, h.capacity * sizeof(slot), mappedSize)
+        && fits(h.arenaOffset, h.arenaSize, mappedSize);
+    if (valid) {
+        ctrl = base + h.ctrlOffset;
+        slots = reinterpret_cast<const slot *>(base + h.slotOffset);
+        arena = reinterpret_cast<const char *>(base + h.arenaOffset);
+        mask = h.capacity - 1;
+        valid = checkSlots();
+    }
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// A lookup reads the word of any occupied slot it probes, and stops at
+// the first empty one, so every word must lie within the arena, the
+// cloned control bytes must match, and at least one slot must be empty
+bool dictIndex::checkSlots() const {
+    uint64_t capacity = pHeader->capacity;
+    uint64_t arenaSize = pHeader->arenaSize;
+    bool anyEmpty = false;
+    for (uint64_t i = 0; i < capacity; i++) {
+        if (i < ctrlGroup::WIDTH - 1 && ctrl[capacity + i] != ctrl[i]) {
+            return false;
+        }
+        if (ctrl[i] == ctrlGroup::EMPTY) {
+            anyEmpty = true;
+        } else if (!fits(slots[i].offset, slots[i].length, arenaSize)) {
+            return false;
+        }
+    }
+    return anyEmpty;
+}
+
+// Probe the mapped table one group of control bytes at a time
+bool dictIndex::contains(std::string_view word) const {
+    uint64_t hashVal = hashWyhash(word.data(), word.size());
+    unsigned char fp = ctrlGroup::fingerprint(hashVal);
+    unsigned int pos = hashVal & mask;
+    while (true) {
+        const unsigned char *group = ctrl + pos;
+        unsigned int empty = ctrlGroup::match(group, ctrlGroup::EMPTY);
+        unsigned int candidates = ctrlGroup::match(group, fp);
+        // The probe sequence ends at the first empty slot
+        if (empty) {
+            candidates &= (empty & -empty) - 1;
+        }
+        while (candidates) {
+            const slot &s = slots[(pos + __builtin_ctz(candidates)) & mask];
+            if (s.length == word.size() && memcmp(arena + s.offset, word.data(), s.length) == 0) {
+                return true;
+            }
+            candidates &= candidates - 1;
+        }
+        if (empty) {
+            return false;
+        }
+        pos = (pos + ctrlGroup::WIDTH) & mask;
+    }
+}
+
+int dictIndex::size() const {
+    return pHeader ? static_cast<int>(pHeader->count) : 0;
+}
+
+void dictIndex::close() {
+    if (base) {
+        munmap(const_cast<unsigned char *>(base), mappedSize);
+    }
+    base = nullptr;
+    mappedSize = 0;
+    pHeader = nullptr;
+    ctrl = nullptr;
+    slots = nullptr;
+    arena = nullptr;
+    mask = 0;
+}
+
+dictIndex::~dictIndex() {
+    close();
+}
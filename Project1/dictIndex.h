@@ -0,0 +1,89 @@
+#ifndef _DICT_INDEX_H
+#define _DICT_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include "hash.h"
+
+//
+// dictIndex - a read-only dictionary served from a memory-mapped index
+// file.
+//
+// An index file holds a finished hash table: a header, the control
+// bytes (fingerprints), one {offset, length} slot per control byte,
+// and a string arena with the words. Lookups probe the mapped file in
+// place, the same way hashTable probes its arrays, so opening an index
+// needs no parsing and no allocation, and every process that opens the
+// same file shares its pages in the page cache. Opening does read the
+// control bytes and slots once, to check that a corrupt or truncated
+// file cannot send a lookup outside the mapping.
+//
+class dictIndex {
+
+ public:
+
+  dictIndex() = default;
+  ~dictIndex();
+  dictIndex(const dictIndex &) = delete;
+  dictIndex &operator=(const dictIndex &) = delete;
+
+  // Write an index file holding every key of the dictionary.
+  // Returns true on success, false if the file cannot be written.
+  static bool build(hashTable &dictionary, const std::string &indexFile);
+
+  // Check if the file starts with the index file signature.
+  static bool isIndexFile(const std::string &file);
+
+  // Map an index file read-only.
+  // Returns true on success,
+  // false if the file cannot be mapped or is not a valid index.
+  bool open(const std::string &indexFile);
+
+  // Check if the word is in the dictionary.
+  bool contains(std::string_view word) const;
+
+  // The number of words in the index.
+  int size() const;
+
+ private:
+
+  // The file starts with this header; the sections follow at the
+  // given offsets, each aligned to 8 bytes.
+  struct header {
+    char magic[8];
+    uint64_t capacity; // Slots in the table (a power of two).
+    uint64_t count; // Words in the table.
+    uint64_t ctrlOffset; // capacity + ctrlGroup::WIDTH - 1 control bytes.
+    uint64_t slotOffset; // capacity slots.
+    uint64_t arenaOffset; // The bytes of every word, back to back.
+    uint64_t arenaSize;
+  };
+
+  // Where a word lives in the arena.
+  struct slot {
+    uint32_t offset;
+    uint32_t length;
+  };
+
+  static constexpr char MAGIC[8] = {'D', 'I', 'C', 'T', 'I', 'D', 'X', '1'};
+
+  const unsigned char *base {nullptr}; // The start of the mapping.
+  size_t mappedSize {0};
+  const header *pHeader {nullptr};
+  const unsigned char *ctrl {nullptr};
+  const slot *slots {nullptr};
+  const char *arena {nullptr};
+  unsigned int mask {0};
+
+  // Unmap the current file, if any.
+  void close();
+
+  // Check every slot of the mapped table against the header, so that
+  // no lookup can read outside the mapping or probe forever.
+  // Returns true if the table is sound.
+  bool checkSlots() const;
+};
+
+#endif //_DICT_INDEX_H
@@ -0,0 +1,99 @@
+//
+// Benchmark for hashTable growth.
+//
+// Inserts distinct keys into a hashTable(0) until it holds 10 million
+// (or the given number), so the table rehashes all the way up from its
+// smallest capacity. For stop-the-world and incremental rehashing it
+// reports the total insert time, and then, timing every insert of a
+// second run, each rehash pause: the inserts that took over 100
+// microseconds, with the number of keys in the table at the time.
+//
+// Keys are the decimal digits of a scrambled counter, written into a
+// small buffer as they are needed, so the benchmark holds no key list
+// of its own.
+//
+// Usage: growthBench.exe [keys]
+//
+
+#include "hash.h"
+
+#include <iostream>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+
+// Write the key for counter i into buffer; keys are distinct for distinct i
+static std::string_view makeKey(uint64_t i, char *buffer) {
+    // Multiplying by an odd constant is a bijection on 64-bit values
+    uint64_t scrambled = i * 0x9E3779B97F4A7C15ull;
+    char *end = std::to_chars(buffer, buffer + 24, scrambled, 36).ptr;
+    return std::string_view(buffer, end - buffer);
+}
+
+// Insert count keys into an empty table; returns the elapsed seconds
+static double timeGrowth(int count, bool incremental) {
+    char buffer[24];
+    hashTable table(0);
+    table.setIncrementalRehash(incremental);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        table.insert(makeKey(i, buffer));
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (table.size() != count) {
+        std::cout << "  error: " << table.size() << " keys in the table" << std::endl;
+    }
+    return secs;
+}
+
+// Insert count keys, timing each insert, and list the slow ones
+static void listPauses(int count, bool incremental) {
+    const double PAUSE_SECS = 100e-6;
+    char buffer[24];
+    hashTable table(0);
+    table.setIncrementalRehash(incremental);
+    double longest = 0;
+    int pauses = 0;
+    for (int i = 0; i < count; i++) {
+        std::string_view key = makeKey(i, buffer);
+        auto start = std::chrono::steady_clock::now();
+        table.insert(key);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        longest = std::max(longest, secs);
+        if (secs > PAUSE_SECS) {
+            pauses++;
+            if (pauses <= 20) {
+                std::cout << "    pause at " << i << " keys: " << 1e3 * secs << " ms" << std::endl;
+            }
+        }
+    }
+    std::cout << "  " << pauses << " inserts over " << 1e6 * PAUSE_SECS << " us, longest "
+              << 1e3 * longest << " ms" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 10000000;
+    std::cout << count << " keys" << std::endl;
+
+    // The cost of making the keys, to set against the insert times
+    char buffer[24];
+    size_t totalLength = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        totalLength += makeKey(i, buffer).size();
+    }
+    double keySecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "making keys: " << keySecs << " s (average length "
+              << static_cast<double>(totalLength) / count << ")" << std::endl;
+
+    for (bool incremental : {false, true}) {
+        double secs = timeGrowth(count, incremental);
+        std::cout << (incremental ? "incremental" : "stop-the-world") << " rehash: " << secs << " s, "
+                  << 1e9 * (secs - keySecs) / count << " ns/insert" << std::endl;
+        listPauses(count, incremental);
+    }
+    return 0;
+}
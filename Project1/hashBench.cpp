@@ -0,0 +1,216 @@
+//
+// Benchmark for the hashTable lookup engine.
+//
+// Compares hashTable, which probes a group of control bytes at a time,
+// against the one-slot-at-a-time linear probe it replaced, on the
+// spellcheck dictionary workload: load every dictionary word, then look
+// up correctly spelled and misspelled words.
+//
+// It also reports the insert latency of loading the dictionary with
+// stop-the-world and with incremental rehashing.
+//
+// Hits are not faster everywhere. On the 200000-word dictionary both
+// tables hit in about the same time. On a million random words, where
+// neither table fits in cache, hashTable hits are about 40% slower
+// (around 145 ns against 100 ns): a hit reads a control byte and then
+// its slot, two cache misses, where the linear probe's first slot
+// usually holds the key. hashTable still wins overall: misses, the
+// lookups a spellcheck spends most of its probing on, are three to
+// five times faster, and loading takes less than half the time.
+//
+// Usage: hashBench.exe [dictionary [document]]
+// Without a dictionary, random words are generated. Without a document,
+// hits (dictionary words) and misses (misspelled variants) are timed
+// separately.
+//
+
+#include "hash.h"
+#include "benchUtil.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+// The hash table as it was before the group-probing engine: an array of
+// items, prime capacities and one slot per probe step.
+class linearTable {
+  public:
+    linearTable(int size = 0) {
+        capacity = getPrime(size);
+        data.resize(capacity);
+        filled = 0;
+    }
+
+    int insert(const std::string &key) {
+        if (static_cast<double>(filled) / capacity >= 0.5) {
+            rehash();
+        }
+        int pos = hash(key);
+        while (data[pos].isOccupied) {
+            if (data[pos].key == key) {
+                return 1;
+            }
+            pos = (pos + 1) % capacity;
+        }
+        data[pos].key = key;
+        data[pos].isOccupied = true;
+        filled++;
+        return 0;
+    }
+
+    bool contains(const std::string &key) {
+        int pos = hash(key);
+        while (data[pos].isOccupied) {
+            if (data[pos].key == key) {
+                return true;
+            }
+            pos = (pos + 1) % capacity;
+        }
+        return false;
+    }
+
+  private:
+    struct hashItem {
+        std::string key;
+        bool isOccupied = false;
+        bool isDeleted = false;
+        void *pv = nullptr;
+    };
+
+    int capacity;
+    int filled;
+    std::vector<hashItem> data;
+
+    int hash(const std::string &key) {
+        unsigned int hashVal = 0;
+        for (char ch : key)
+            hashVal = 37 * hashVal + ch;
+        return hashVal % capacity;
+    }
+
+    void rehash() {
+        std::vector<hashItem> old = std::move(data);
+        capacity = getPrime(capacity);
+        data.clear();
+        data.resize(capacity);
+        filled = 0;
+        for (const auto &item : old) {
+            if (item.isOccupied) {
+                insert(item.key);
+            }
+        }
+    }
+
+    static int getPrime(int size) {
+        static const std::vector<int> primes = {
+            101039, 202079, 404113, 808217, 1616437, 3232877, 6465767, 12931529, 25863059,
+            51726121, 103452249, 206904483, 413809041, 827618087, 1655236173
+        };
+        for (int prime : primes) {
+            if (prime > size) {
+                return prime;
+            }
+        }
+        return primes.back();
+    }
+};
+
+// Read the lowercased words of a document, split into tokens the way
+// spellcheck does
+static std::vector<std::string> readDocument(const std::string &file) {
+    std::ifstream input(file);
+    std::vector<std::string> words;
+    std::string word;
+    char c;
+    while (input.get(c)) {
+        c = tolower(c);
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '\'') {
+            word += c;
+        } else if (!word.empty()) {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+// A named stream of words to look up
+struct lookupSet {
+    std::string name;
+    std::vector<std::string> words;
+};
+
+// Run one table through the workload and print its timings
+template <typename Table>
+static void runWorkload(const std::string &name, const std::vector<std::string> &dictionary,
+                        const std::vector<lookupSet> &lookups) {
+    auto start = std::chrono::steady_clock::now();
+    Table table(0);
+    for (const auto &word : dictionary) {
+        table.insert(word);
+    }
+    double loadSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": load " << loadSecs << " s" << std::endl;
+    for (const auto &set : lookups) {
+        long found = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto &word : set.words) {
+            found += table.contains(word);
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << set.name << ": " << set.words.size() / secs / 1e6 << " M lookups/s, "
+                  << 1e9 * secs / set.words.size() << " ns/lookup, " << found << " found" << std::endl;
+    }
+}
+
+// Time every insert of a dictionary load and print the worst ones
+static void runLatency(const std::string &name, bool incremental, const std::vector<std::string> &dictionary) {
+    std::vector<double> latencies;
+    latencies.reserve(dictionary.size());
+    hashTable table(0);
+    table.setIncrementalRehash(incremental);
+    auto loadStart = std::chrono::steady_clock::now();
+    for (const auto &word : dictionary) {
+        auto start = std::chrono::steady_clock::now();
+        table.insert(word);
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    double loadSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << name << ": load " << loadSecs << " s, insert latency p99.99 "
+              << latencies[latencies.size() * 9999 / 10000] << " us, max " << latencies.back() << " us" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::mt19937 rng(12345);
+    std::vector<std::string> dictionary = argc > 1 ? readDictionary(argv[1]) : randomWords(1000000, rng);
+    std::vector<lookupSet> lookups;
+    if (argc > 2) {
+        lookups.push_back({"document", readDocument(argv[2])});
+    } else {
+        // Correctly spelled words, and the same words misspelled
+        std::uniform_int_distribution<size_t> pick(0, dictionary.size() - 1);
+        lookupSet hits{"hits", {}}, misses{"misses", {}};
+        for (int i = 0; i < 2000000; i++) {
+            std::string word = dictionary[pick(rng)];
+            hits.words.push_back(word);
+            word += '#';
+            misses.words.push_back(word);
+        }
+        lookups.push_back(hits);
+        lookups.push_back(misses);
+    }
+    std::cout << dictionary.size() << " dictionary words" << std::endl;
+    runWorkload<linearTable>("linear probe", dictionary, lookups);
+    runWorkload<hashTable>("group probe", dictionary, lookups);
+    runLatency("stop-the-world rehash", false, dictionary);
+    runLatency("incremental rehash", true, dictionary);
+    return 0;
+}
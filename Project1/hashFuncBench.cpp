@@ -0,0 +1,123 @@
+//
+// Benchmark for the hash functions a hashTable can be built with.
+//
+// For every hash function and key set, reports the insert throughput,
+// the average probe length of a successful lookup, and the lookup
+// throughput once the table is full.
+//
+// Usage: hashFuncBench.exe [dictionary [graph]]
+// The key sets are the dictionary words, the vertex ids of the graph
+// file, and a set of long keys. Without files, random words and the
+// ids v1 ... v1000000 are used instead.
+//
+
+#include "hash.h"
+#include "benchUtil.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+// A named set of distinct keys
+struct keySet {
+    std::string name;
+    std::vector<std::string> keys;
+};
+
+// Read the vertex ids of a graph file, in order of first appearance
+static std::vector<std::string> readVertices(const std::string &file) {
+    std::ifstream input(file);
+    std::vector<std::string> ids;
+    hashTable seen;
+    std::string line, startingV, endingV;
+    while (getline(input, line)) {
+        std::stringstream ss(line);
+        ss >> startingV >> endingV;
+        for (const auto &v : {startingV, endingV}) {
+            if (seen.insert(v) == 0) {
+                ids.push_back(v);
+            }
+        }
+    }
+    return ids;
+}
+
+// Generate random strings over the given alphabet
+static std::vector<std::string> randomKeys(int count, int minLength, int maxLength,
+                                           const std::string &alphabet, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> length(minLength, maxLength);
+    std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+    std::vector<std::string> keys(count);
+    for (auto &key : keys) {
+        int n = length(rng);
+        for (int i = 0; i < n; i++) {
+            key += alphabet[letter(rng)];
+        }
+    }
+    return keys;
+}
+
+// Time one hash function on one key set
+static void runPolicy(hashFunction kind, const keySet &set, const std::vector<std::string> &lookups) {
+    auto start = std::chrono::steady_clock::now();
+    hashTable table(0, kind);
+    for (const auto &key : set.keys) {
+        table.insert(key);
+    }
+    double insertSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    long found = 0;
+    for (const auto &key : lookups) {
+        found += table.contains(key);
+    }
+    double lookupSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << getHashFunctionName(kind) << ": "
+              << set.keys.size() / insertSecs / 1e6 << " M inserts/s, "
+              << "probe length " << table.averageProbeLength() << ", "
+              << lookups.size() / lookupSecs / 1e6 << " M lookups/s"
+              << (found == static_cast<long>(lookups.size()) ? "" : " (MISSING KEYS)") << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::mt19937 rng(12345);
+    std::vector<keySet> sets;
+    sets.push_back({"dictionary", argc > 1 ? readDictionary(argv[1])
+                                           : randomKeys(1000000, 3, 14, "abcdefghijklmnopqrstuvwxyz", rng)});
+    keySet vertices{"graph vertices", {}};
+    if (argc > 2) {
+        vertices.keys = readVertices(argv[2]);
+    } else {
+        for (int i = 1; i <= 1000000; i++) {
+            vertices.keys.push_back("v" + std::to_string(i));
+        }
+    }
+    sets.push_back(vertices);
+    sets.push_back({"long keys", randomKeys(200000, 64, 256, "abcdefghijklmnopqrstuvwxyz/._-0123456789", rng)});
+
+    const hashFunction kinds[] = {
+        hashFunction::weiss, hashFunction::fnv1a, hashFunction::wyhash, hashFunction::xxh3, hashFunction::simd
+    };
+    for (auto &set : sets) {
+        // Drop duplicates so every lookup is a hit
+        hashTable unique;
+        std::vector<std::string> keys;
+        for (auto &key : set.keys) {
+            if (unique.insert(key) == 0) {
+                keys.push_back(key);
+            }
+        }
+        set.keys = keys;
+        std::vector<std::string> lookups = keys;
+        std::shuffle(lookups.begin(), lookups.end(), rng);
+        std::cout << set.name << " (" << set.keys.size() << " keys)" << std::endl;
+        for (hashFunction kind : kinds) {
+            runPolicy(kind, set, lookups);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,236 @@
+#ifndef _HASH_FUNCTIONS_H
+#define _HASH_FUNCTIONS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//
+// String hash functions that a hashTable can be constructed with.
+// Each one maps a byte string to a 64-bit value whose low bits choose
+// the home slot and whose top bits become the slot's fingerprint.
+//
+enum class hashFunction {
+  weiss, // The 37 * h + ch polynomial from Weiss, with a final mix
+  fnv1a, // 64-bit FNV-1a
+  wyhash, // wyhash (final version 4)
+  xxh3, // Mixing in the style of XXH3; not bit-compatible with it
+  simd // SSE2 stripe accumulation for long keys, wyhash for short ones
+};
+
+typedef uint64_t (*hashFn)(const char *data, size_t len);
+
+// Constants shared by the wyhash, xxh3 and simd functions.
+static const uint64_t hashSecret[8] = {
+  0x2e84496e7857dd87ull, 0x940eee3cba6f875dull, 0x33406bc44dc2a627ull, 0xb938451ee325faa7ull,
+  0xc1d8fac168fb90d7ull, 0xc2354e2bb7740a63ull, 0x887e840043e58845ull, 0xa2da95a83ec33dd7ull
+};
+
+inline uint64_t hashRead64(const unsigned char *p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+
+inline uint64_t hashRead32(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+// Multiply to 128 bits and fold the halves together.
+inline uint64_t hashMulFold(uint64_t a, uint64_t b) {
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+// The XXH3 final avalanche.
+inline uint64_t hashAvalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= 0x165667919E3779F9ull;
+  h ^= h >> 32;
+  return h;
+}
+
+// Hash function taken from Data Structures and Algorithms Analysis in C++ by Mark A. Weiss pg 195
+// The polynomial only fills 32 bits and is weak in its low bits, so it
+// is spread over 64 bits before use
+inline uint64_t hashWeiss(const char *data, size_t len) {
+  unsigned int hashVal = 0;
+  for (size_t i = 0; i < len; i++)
+    hashVal = 37 * hashVal + data[i];
+  uint64_t mixed = hashVal * 0x9E3779B97F4A7C15ull;
+  return mixed ^ (mixed >> 32);
+}
+
+inline uint64_t hashFnv1a(const char *data, size_t len) {
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < len; i++) {
+    h ^= static_cast<unsigned char>(data[i]);
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
+// wyhash by Wang Yi, with a fixed seed and the original secret
+inline uint64_t hashWyhash(const char *data, size_t len) {
+  static const uint64_t wyp[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+  };
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+  uint64_t seed = hashMulFold(wyp[0], wyp[1]);
+  uint64_t a, b;
+  if (len <= 16) {
+    if (len >= 4) {
+      a = (hashRead32(p) << 32) | hashRead32(p + ((len >> 3) << 2));
+      b = (hashRead32(p + len - 4) << 32) | hashRead32(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = hashMulFold(hashRead64(p) ^ wyp[1], hashRead64(p + 8) ^ seed);
+        see1 = hashMulFold(hashRead64(p + 16) ^ wyp[2], hashRead64(p + 24) ^ see1);
+        see2 = hashMulFold(hashRead64(p + 32) ^ wyp[3], hashRead64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = hashMulFold(hashRead64(p) ^ wyp[1], hashRead64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = hashRead64(p + i - 16);
+    b = hashRead64(p + i - 8);
+  }
+  a ^= wyp[1];
+  b ^= seed;
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+  return hashMulFold(a ^ wyp[0] ^ len, b ^ wyp[1]);
+}
+
+// Each 16-byte block is keyed, multiplied and folded into the
+// accumulator, as XXH3 does for short and medium inputs
+inline uint64_t hashXxh3(const char *data, size_t len) {
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+  uint64_t acc = len * 0x9E3779B185EBCA87ull;
+  if (len <= 16) {
+    uint64_t lo, hi;
+    if (len >= 8) {
+      lo = hashRead64(p);
+      hi = hashRead64(p + len - 8);
+    } else if (len >= 4) {
+      lo = hashRead32(p);
+      hi = hashRead32(p + len - 4);
+    } else if (len > 0) {
+      lo = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+      hi = 0;
+    } else {
+      lo = hi = 0;
+    }
+    return hashAvalanche(acc + hashMulFold(lo ^ hashSecret[0], hi ^ hashSecret[1]));
+  }
+  size_t block = 0;
+  for (size_t i = 0; i + 16 < len; i += 16, block += 2) {
+    acc += hashMulFold(hashRead64(p + i) ^ hashSecret[block & 7], hashRead64(p + i + 8) ^ hashSecret[(block + 1) & 7]);
+  }
+  // The last block is read from the end, overlapping the previous one
+  acc += hashMulFold(hashRead64(p + len - 16) ^ hashSecret[block & 7], hashRead64(p + len - 8) ^ hashSecret[(block + 1) & 7]);
+  return hashAvalanche(acc);
+}
+
+// Accumulate one 64-byte stripe into eight 64-bit lanes, as XXH3 does
+// for long inputs
+inline void hashAccumulate(uint64_t *acc, const unsigned char *p) {
+#ifdef __SSE2__
+  __m128i *accVec = reinterpret_cast<__m128i *>(acc);
+  for (int i = 0; i < 4; i++) {
+    __m128i dataVec = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p) + i);
+    __m128i keyVec = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hashSecret) + i);
+    __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+    // Multiply the low and high 32 bits of each keyed lane
+    __m128i product = _mm_mul_epu32(dataKey, _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+    // Add the neighbouring lane's input so no bits are lost to a zero key
+    __m128i swapped = _mm_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+    accVec[i] = _mm_add_epi64(accVec[i], _mm_add_epi64(product, swapped));
+  }
+#else
+  for (int i = 0; i < 8; i++) {
+    uint64_t dataKey = hashRead64(p + 8 * i) ^ hashSecret[i];
+    acc[i] += hashRead64(p + 8 * (i ^ 1)) + (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+  }
+#endif
+}
+
+// Long keys are split into 64-byte stripes accumulated with SSE2
+// Keys shorter than one stripe gain nothing from that and use wyhash
+inline uint64_t hashSimd(const char *data, size_t len) {
+  if (len < 64) {
+    return hashWyhash(data, len);
+  }
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+  alignas(16) uint64_t acc[8];
+  for (int i = 0; i < 8; i++) {
+    acc[i] = hashSecret[7 - i];
+  }
+  size_t i = 0;
+  for (; i + 64 < len; i += 64) {
+    hashAccumulate(acc, p + i);
+  }
+  // The last stripe is read from the end, overlapping the previous one
+  hashAccumulate(acc, p + len - 64);
+  uint64_t h = len * 0x9E3779B185EBCA87ull;
+  for (int k = 0; k < 4; k++) {
+    h += hashMulFold(acc[2 * k] ^ hashSecret[2 * k], acc[2 * k + 1] ^ hashSecret[2 * k + 1]);
+  }
+  return hashAvalanche(h);
+}
+
+// Return the function for a hashFunction value.
+inline hashFn getHashFunction(hashFunction kind) {
+  switch (kind) {
+  case hashFunction::weiss:
+    return hashWeiss;
+  case hashFunction::fnv1a:
+    return hashFnv1a;
+  case hashFunction::xxh3:
+    return hashXxh3;
+  case hashFunction::simd:
+    return hashSimd;
+  case hashFunction::wyhash:
+  default:
+    return hashWyhash;
+  }
+}
+
+// Return a printable name for a hashFunction value.
+inline const char *getHashFunctionName(hashFunction kind) {
+  switch (kind) {
+  case hashFunction::weiss:
+    return "weiss";
+  case hashFunction::fnv1a:
+    return "fnv1a";
+  case hashFunction::xxh3:
+    return "xxh3";
+  case hashFunction::simd:
+    return "simd";
+  case hashFunction::wyhash:
+  default:
+    return "wyhash";
+  }
+}
+
+#endif //_HASH_FUNCTIONS_H
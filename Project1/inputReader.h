@@ -0,0 +1,93 @@
+#ifndef _INPUT_READER_H
+#define _INPUT_READER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+//
+// inputReader - reads a text file as views into memory.
+//
+// A regular file is memory-mapped, and lines and fields are views into
+// the mapping, so nothing is copied. Other inputs (pipes, or files too
+// large to map) are read in large blocks into a buffer after
+// posix_fadvise announces sequential access; views then point into the
+// buffer.
+//
+// A view returned by getLine, getLines, getField or getFields stays
+// valid until the next call on the reader (for a mapped file, until it
+// is closed).
+//
+class inputReader {
+
+ public:
+
+  inputReader() = default;
+  ~inputReader();
+  inputReader(const inputReader &) = delete;
+  inputReader &operator=(const inputReader &) = delete;
+
+  // Open the specified file for reading.
+  // Returns true on success, false if the file cannot be opened.
+  bool open(const std::string &file);
+
+  // Read from a descriptor that is already open, such as a pipe or a
+  // socket. The reader owns it from then on and closes it.
+  // Returns true on success, false if the descriptor is -1.
+  bool open(int descriptor);
+
+  // Close the file, if any.
+  void close();
+
+  // Read the next line, without its newline, as getline does: a last
+  // line without a newline still counts.
+  // Returns true on success, false at the end of the file.
+  bool getLine(std::string_view &line);
+
+  // Read the next whole lines, up to about maxBytes of them, including
+  // their newlines. A single line longer than maxBytes is returned on
+  // its own.
+  // Returns true on success, false at the end of the file.
+  bool getLines(std::string_view &lines, size_t maxBytes);
+
+  // Read the next field separated by whitespace, as >> does.
+  // Returns true on success, false at the end of the file.
+  bool getField(std::string_view &field);
+
+  // Read the next count fields into the fields array. Unlike count
+  // calls to getField, all of the views stay valid together.
+  // Returns true on success,
+  // false if the file ends before count fields are read.
+  bool getFields(std::string_view *fields, int count);
+
+  // True if the file is memory-mapped rather than streamed.
+  bool isMapped() const { return mapped; }
+
+ private:
+
+  // Streamed input is read this many bytes at a time.
+  static constexpr size_t BLOCK_SIZE = 1 << 20;
+
+  // Regular files up to this size are mapped.
+  static constexpr size_t MAX_MAP_SIZE = sizeof(void *) >= 8 ? static_cast<size_t>(1) << 40 : 1 << 28;
+
+  int fd {-1};
+  bool mapped {false};
+  bool atEnd {false}; // True once a streamed file has been read to the end.
+  const char *data {nullptr}; // The mapping, or the start of buffer.
+  size_t pos {0}; // The next unread byte of data.
+  size_t length {0}; // The bytes of data available.
+  std::vector<char> buffer; // Holds streamed input.
+
+  // Read more of a streamed file, first moving the unread bytes to the
+  // front of the buffer (so pos becomes 0).
+  // Returns true if anything was read, false at the end of the file.
+  bool readMore();
+
+  // Return the offset just past the end of the line that starts at pos,
+  // scanning from offset pos + skip and reading more input as needed.
+  size_t findLineEnd(size_t skip);
+};
+
+#endif //_INPUT_READER_H
@@ -0,0 +1,80 @@
+//
+// Benchmark for writing spellcheck reports.
+//
+// Writes the same "Unknown word" report lines through std::ofstream
+// with std::endl (as the spellchecker used to), std::ofstream with
+// '\n', and outputBuffer, and reports the throughput and the number of
+// write system calls per MB of output. System calls are counted from
+// the syscw field of /proc/self/io.
+//
+// Usage: outputBench.exe [lines [scratch file]]
+//
+
+#include "outputBuffer.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+// The number of write system calls made by this process so far
+static long writeSyscalls() {
+    std::ifstream io("/proc/self/io");
+    std::string field;
+    long value;
+    while (io >> field >> value) {
+        if (field == "syscw:") {
+            return value;
+        }
+    }
+    return -1;
+}
+
+// Time one way of writing the reports
+template <typename F>
+static void run(const std::string &name, const std::string &file, F writeReports) {
+    long startCalls = writeSyscalls();
+    auto start = std::chrono::steady_clock::now();
+    writeReports(file);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long calls = writeSyscalls() - startCalls;
+    std::ifstream written(file, std::ios::binary | std::ios::ate);
+    double mb = written.tellg() / 1e6;
+    std::cout << "  " << name << ": " << mb / secs << " MB/s, ";
+    if (startCalls < 0) {
+        std::cout << "write calls not available" << std::endl;
+    } else {
+        std::cout << calls / mb << " write calls per MB" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    int lines = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    std::string file = argc > 2 ? argv[2] : "outputBench.tmp";
+    const std::vector<std::string> words = {"teh", "recieve", "seperate", "occured", "definately", "wierd"};
+
+    std::cout << lines << " report lines" << std::endl;
+    run("ofstream, std::endl", file, [&](const std::string &f) {
+        std::ofstream output(f);
+        for (int i = 0; i < lines; i++) {
+            output << "Unknown word at line " << i + 1 << ": " << words[i % words.size()] << std::endl;
+        }
+    });
+    run("ofstream, '\\n'", file, [&](const std::string &f) {
+        std::ofstream output(f);
+        for (int i = 0; i < lines; i++) {
+            output << "Unknown word at line " << i + 1 << ": " << words[i % words.size()] << '\n';
+        }
+    });
+    run("outputBuffer", file, [&](const std::string &f) {
+        outputBuffer output;
+        output.open(f);
+        for (int i = 0; i < lines; i++) {
+            output << "Unknown word at line " << i + 1 << ": " << words[i % words.size()] << '\n';
+        }
+    });
+    std::remove(file.c_str());
+    return 0;
+}
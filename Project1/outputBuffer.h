@@ -0,0 +1,105 @@
+#ifndef _OUTPUT_BUFFER_H
+#define _OUTPUT_BUFFER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <charconv>
+#include <limits>
+#include <type_traits>
+#include <cstddef>
+
+struct iovec;
+
+//
+// outputBuffer - buffered text output for reports.
+//
+// Text is gathered in a large user-space buffer and handed to the
+// kernel with one write call when the buffer fills, rather than once
+// per line as with std::endl. Numbers are formatted with std::to_chars
+// straight into the buffer. A piece of text at least as large as the
+// buffer is not copied; it goes out together with the buffered text
+// in a single writev call.
+//
+// An outputBuffer that is never opened keeps everything written to it
+// in memory, so reports built on worker threads can be written to the
+// file afterwards, in order.
+//
+class outputBuffer {
+
+ public:
+
+  // The constructor sets the size of the buffer used once a file is
+  // opened. Nothing is allocated until text is written.
+  explicit outputBuffer(size_t bufferSize = 1 << 20);
+
+  // The destructor flushes the buffer and closes the file.
+  ~outputBuffer();
+
+  outputBuffer(const outputBuffer &) = delete;
+  outputBuffer &operator=(const outputBuffer &) = delete;
+
+  // Open the specified file for writing, replacing its contents.
+  // Returns true on success,
+  // false if the file cannot be opened (later output is discarded).
+  bool open(const std::string &file);
+
+  // Write the buffered text to the file and close it.
+  // Returns true if every write succeeded.
+  bool close();
+
+  // Write the buffered text to the file; does nothing in memory.
+  // Returns true on success, false if a write has failed.
+  bool flush();
+
+  // Append length bytes of text.
+  void write(const char *data, size_t length);
+
+  outputBuffer &operator<<(std::string_view s) {
+    write(s.data(), s.size());
+    return *this;
+  }
+
+  outputBuffer &operator<<(char c) {
+    *reserve(1) = c;
+    used++;
+    return *this;
+  }
+
+  // Integers are formatted in place with std::to_chars.
+  template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+  outputBuffer &operator<<(T n) {
+    const size_t maxDigits = std::numeric_limits<T>::digits10 + 2;
+    char *p = reserve(maxDigits);
+    used = std::to_chars(p, p + maxDigits, n).ptr - buffer.data();
+    return *this;
+  }
+
+  // The text written since the last flush; for a buffer that was never
+  // opened, everything written to it.
+  std::string_view view() const { return std::string_view(buffer.data(), used); }
+
+  // The number of write and writev calls made so far.
+  long writeCalls() const { return calls; }
+
+  // False once the file could not be opened or a write has failed.
+  bool good() const { return ok; }
+
+ private:
+
+  std::vector<char> buffer; // Holds the text not yet written.
+  size_t used {0}; // Bytes of buffer in use.
+  size_t bufferSize; // The size of buffer once a file is open.
+  int fd {-1}; // The open file, or -1 to keep the text in memory.
+  bool ok {true};
+  long calls {0};
+
+  // Return room for n more bytes at the end of the buffered text,
+  // flushing the buffer (or, in memory, growing it) when needed.
+  char *reserve(size_t n);
+
+  // Write the pieces to the file, retrying after partial writes.
+  bool writeAll(iovec *iov, int count);
+};
+
+#endif //_OUTPUT_BUFFER_H
@@ -0,0 +1,274 @@
+#include "perfectDict.h"
+
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Round an offset up to the next multiple of 8
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+// Scale the high bits of a 64-bit value to [0, n)
+static uint64_t scaleTo(uint64_t x, uint64_t n) {
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(x) * n) >> 64);
+}
+
+uint64_t perfectDict::bucketOf(uint64_t hashVal, uint64_t numBuckets) {
+    return scaleTo(hashVal, numBuckets);
+}
+
+// Mix the pilot into the hash value, as PTHash does, and scale to a slot
+uint64_t perfectDict::slotOf(uint64_t hashVal, uint32_t pilot, uint64_t count) {
+    return scaleTo(hashAvalanche(hashVal ^ (pilot * 0x9E3779B97F4A7C15ull)), count);
+}
+
+// Group the words by bucket, then find a pilot for every bucket,
+// largest first
+bool perfectDict::findPilots(const std::vector<uint64_t> &hashes, uint64_t numBuckets,
+                             std::vector<uint32_t> &pilotValues, std::vector<uint32_t> &slotWord) {
+    uint64_t count = hashes.size();
+    // Group the words by bucket with a counting sort
+    std::vector<uint32_t> bucketStart(numBuckets + 1, 0);
+    for (uint64_t hashVal : hashes) {
+        bucketStart[bucketOf(hashVal, numBuckets) + 1]++;
+    }
+    std::partial_sum(bucketStart.begin(), bucketStart.end(), bucketStart.begin());
+    std::vector<uint32_t> bucketWords(count);
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (uint32_t i = 0; i < count; i++) {
+        bucketWords[fill[bucketOf(hashes[i], numBuckets)]++] = i;
+    }
+
+    // Place the largest buckets first, while most slots are still free
+    std::vector<uint32_t> bucketOrder(numBuckets);
+    std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&](uint32_t a, uint32_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+    const uint32_t FREE = UINT32_MAX;
+    slotWord.assign(count, FREE);
+    pilotValues.assign(numBuckets, 0);
+    // The last free slot takes a one-word bucket about count tries to
+    // hit, so a bucket that needs far more than that is not placed
+    uint64_t maxPilot = std::min<uint64_t>(UINT32_MAX, std::max<uint64_t>(MIN_PILOTS, PILOTS_PER_WORD * count));
+    std::vector<uint64_t> tried;
+    for (uint32_t b : bucketOrder) {
+        if (bucketStart[b + 1] == bucketStart[b]) {
+            // The rest of the buckets are empty too
+            break;
+        }
+        // Try pilots until every word of the bucket lands in its own free slot
+        for (uint64_t pilot = 0;; pilot++) {
+            if (pilot == maxPilot) {
+                return false;
+            }
+            tried.clear();
+            for (uint32_t i = bucketStart[b]; i < bucketStart[b + 1]; i++) {
+                uint64_t slot = slotOf(hashes[bucketWords[i]], pilot, count);
+                if (slotWord[slot] != FREE || std::find(tried.begin(), tried.end(), slot) != tried.end()) {
+                    break;
+                }
+                tried.push_back(slot);
+            }
+            if (tried.size() == bucketStart[b + 1] - bucketStart[b]) {
+                for (size_t j = 0; j < tried.size(); j++) {
+                    slotWord[tried[j]] = bucketWords[bucketStart[b] + j];
+                }
+                pilotValues[b] = static_cast<uint32_t>(pilot);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+// Find a pilot for every bucket, then lay the words out in slot order
+bool perfectDict::build(hashTable &dictionary) {
+    close();
+    struct entry {
+        uint64_t hashVal;
+        std::string_view word;
+    };
+    // The views stay valid because the table is not changed meanwhile
+    std::vector<entry> entries;
+    entries.reserve(dictionary.size());
+    uint64_t textSize = 0;
+    dictionary.forEach([&](std::string_view word, void *) {
+        entries.push_back({hashWyhash(word.data(), word.size()), word});
+        textSize += word.size();
+    });
+    if (textSize > UINT32_MAX) {
+        return false;
+    }
+    uint64_t count = entries.size();
+    // Two words with the same hash value could never be separated
+    std::vector<uint64_t> hashes(count);
+    for (uint64_t i = 0; i < count; i++) {
+        hashes[i] = entries[i].hashVal;
+    }
+    std::vector<uint64_t> sorted(hashes);
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+        return false;
+    }
+
+    // A failed search is retried with twice as many buckets, whose
+    // smaller buckets are easier to place
+    uint64_t numBuckets = std::max<uint64_t>(1, std::ceil(BUCKET_FACTOR * count / std::max(1.0, std::log2(count))));
+    std::vector<uint32_t> pilotValues, slotWord;
+    int attempts = 1;
+    while (!findPilots(hashes, numBuckets, pilotValues, slotWord)) {
+        if (attempts++ == MAX_ATTEMPTS) {
+            return false;
+        }
+        numBuckets *= 2;
+    }
+
+    // Lay out the image
+    header h;
+    memcpy(h.magic, MAGIC, sizeof(h.magic));
+    h.count = count;
+    h.numBuckets = numBuckets;
+    h.pilotOffset = align8(sizeof(header));
+    h.offsetOffset = align8(h.pilotOffset + numBuckets * sizeof(uint32_t));
+    h.arenaOffset = align8(h.offsetOffset + (count + 1) * sizeof(uint32_t));
+    h.arenaSize = textSize;
+    image.assign(h.arenaOffset + textSize, 0);
+    memcpy(image.data(), &h, sizeof(h));
+    memcpy(image.data() + h.pilotOffset, pilotValues.data(), numBuckets * sizeof(uint32_t));
+    uint32_t *wordOffsets = reinterpret_cast<uint32_t *>(image.data() + h.offsetOffset);
+    char *text = reinterpret_cast<char *>(image.data() + h.arenaOffset);
+    uint32_t offset = 0;
+    for (uint64_t slot = 0; slot < count; slot++) {
+        std::string_view word = entries[slotWord[slot]].word;
+        wordOffsets[slot] = offset;
+        memcpy(text + offset, word.data(), word.size());
+        offset += word.size();
+    }
+    wordOffsets[count] = offset;
+    return attach(image.data(), image.size());
+}
+
+// Write the image as it is
+bool perfectDict::save(const std::string &file) const {
+    if (!pHeader) {
+        return false;
+    }
+    std::ofstream output(file, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char *>(pHeader), imageSize);
+    return static_cast<bool>(output);
+}
+
+// Check the first bytes of the file against the signature
+bool perfectDict::isPerfectDictFile(const std::string &file) {
+    std::ifstream input(file, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+// Map the file and use it as the image
+bool perfectDict::open(const std::string &file) {
+    close();
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(header)) {
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file alive, so the descriptor can go
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    mapped = static_cast<const unsigned char *>(p);
+    if (!attach(mapped, st.st_size)) {
+        // attach failed before setting imageSize, so unmap here
+        munmap(p, st.st_size);
+        mapped = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// Check that length bytes from offset lie within size bytes, without overflow
+static bool fits(uint64_t offset, uint64_t length, uint64_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+// Check the header against the image size before trusting its offsets
+bool perfectDict::attach(const unsigned char *base, size_t length) {
+    if (length < sizeof(header)) {
+        return false;
+    }
+    const header &h = *reinterpret_cast<const header *>(base);
+    bool valid = memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0
+        && h.count < UINT32_MAX && h.numBuckets >= 1 && h.numBuckets <= length
+        && h.pilotOffset % 4 == 0 && fits(h.pilotOffset, h.numBuckets * sizeof(uint32_t), length)
+        && h.offsetOffset % 4 == 0 && fits(h.offsetOffset, (h.count + 1) * sizeof(uint32_t), length)
+        && fits(h.arenaOffset, h.arenaSize, length);
+    if (!valid) {
+        return false;
+    }
+    const uint32_t *wordOffsets = reinterpret_cast<const uint32_t *>(base + h.offsetOffset);
+    // A lookup reads the word between any two neighbouring offsets, so
+    // the offsets must never decrease, and the last must lie within the
+    // arena; then every word does
+    for (uint64_t slot = 0; slot < h.count; slot++) {
+        if (wordOffsets[slot] > wordOffsets[slot + 1]) {
+            return false;
+        }
+    }
+    if (wordOffsets[h.count] > h.arenaSize) {
+        return false;
+    }
+    pHeader = &h;
+    imageSize = length;
+    pilots = reinterpret_cast<const uint32_t *>(base + h.pilotOffset);
+    offsets = wordOffsets;
+    arena = reinterpret_cast<const char *>(base + h.arenaOffset);
+    return true;
+}
+
+// One pilot, one pair of offsets, one compare
+bool perfectDict::contains(std::string_view word) const {
+    if (!pHeader || pHeader->count == 0) {
+        return false;
+    }
+    uint64_t hashVal = hashWyhash(word.data(), word.size());
+    uint32_t pilot = pilots[bucketOf(hashVal, pHeader->numBuckets)];
+    uint64_t slot = slotOf(hashVal, pilot, pHeader->count);
+    uint32_t begin = offsets[slot];
+    return offsets[slot + 1] - begin == word.size() && memcmp(arena + begin, word.data(), word.size()) == 0;
+}
+
+int perfectDict::size() const {
+    return pHeader ? static_cast<int>(pHeader->count) : 0;
+}
+
+void perfectDict::close() {
+    if (mapped) {
+        munmap(const_cast<unsigned char *>(mapped), imageSize);
+    }
+    mapped = nullptr;
+    std::vector<unsigned char>().swap(image);
+    imageSize = 0;
+    pHeader = nullptr;
+    pilots = nullptr;
+    offsets = nullptr;
+    arena = nullptr;
+}
+
+perfectDict::~perfectDict() {
+    close();
+}
@@ -0,0 +1,116 @@
+#ifndef _PERFECT_DICT_H
+#define _PERFECT_DICT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "hash.h"
+
+//
+// perfectDict - a read-only dictionary built on a minimal perfect hash.
+//
+// The words are placed with a PTHash-style minimal perfect hash: each
+// word's hash value picks a bucket, and each bucket stores a pilot
+// value, chosen at build time, that sends every word of the bucket to
+// its own slot in [0, size()). There are exactly as many slots as
+// words, and the words are stored back to back in slot order in a
+// string arena, so slot i holds the word between offsets[i] and
+// offsets[i + 1]. A lookup reads one pilot, one pair of offsets, and
+// compares once; there is no probing.
+//
+// The dictionary is kept as a single image (a header, the pilots, the
+// offsets and the arena). It can be built in memory, saved to a file,
+// and later mapped from that file without any parsing; opening only
+// reads the offsets once, to check that no lookup can leave the image.
+//
+class perfectDict {
+
+ public:
+
+  perfectDict() = default;
+  ~perfectDict();
+  perfectDict(const perfectDict &) = delete;
+  perfectDict &operator=(const perfectDict &) = delete;
+
+  // Build the dictionary from every key of the hash table.
+  // Returns true on success, false if the words do not fit the format
+  // (more than 4 GB of text), two words share a hash value, or no
+  // pilots are found within the search limits below.
+  bool build(hashTable &dictionary);
+
+  // Write the dictionary to a file that open can map.
+  // Returns true on success, false if the file cannot be written.
+  bool save(const std::string &file) const;
+
+  // Check if the file starts with the perfect dictionary signature.
+  static bool isPerfectDictFile(const std::string &file);
+
+  // Map a file written by save, read-only.
+  // Returns true on success,
+  // false if the file cannot be mapped or is not a valid dictionary.
+  bool open(const std::string &file);
+
+  // Check if the word is in the dictionary.
+  bool contains(std::string_view word) const;
+
+  // The number of words in the dictionary.
+  int size() const;
+
+  // The number of bytes the dictionary occupies.
+  size_t memoryBytes() const { return imageSize; }
+
+ private:
+
+  struct header {
+    char magic[8];
+    uint64_t count; // Words, and slots.
+    uint64_t numBuckets;
+    uint64_t pilotOffset; // numBuckets 32-bit pilots.
+    uint64_t offsetOffset; // count + 1 32-bit arena offsets.
+    uint64_t arenaOffset; // The words, in slot order.
+    uint64_t arenaSize;
+  };
+
+  static constexpr char MAGIC[8] = {'D', 'I', 'C', 'T', 'P', 'H', 'F', '1'};
+
+  // Average words per bucket is about log2(count) / BUCKET_FACTOR.
+  static constexpr double BUCKET_FACTOR = 5.0;
+
+  // A bucket is given up on after max(MIN_PILOTS, PILOTS_PER_WORD *
+  // count) pilots, and the search after MAX_ATTEMPTS bucket counts,
+  // each twice the last.
+  static constexpr uint64_t MIN_PILOTS = 1 << 20;
+  static constexpr uint64_t PILOTS_PER_WORD = 64;
+  static constexpr int MAX_ATTEMPTS = 3;
+
+  std::vector<unsigned char> image; // The image, when built in memory.
+  const unsigned char *mapped {nullptr}; // The image, when mapped.
+  size_t imageSize {0};
+  const header *pHeader {nullptr};
+  const uint32_t *pilots {nullptr};
+  const uint32_t *offsets {nullptr};
+  const char *arena {nullptr};
+
+  // The bucket a hash value belongs to.
+  static uint64_t bucketOf(uint64_t hashVal, uint64_t numBuckets);
+
+  // The slot a pilot sends a hash value to.
+  static uint64_t slotOf(uint64_t hashVal, uint32_t pilot, uint64_t count);
+
+  // Find a pilot for every bucket of the hash values, and the word (an
+  // index into hashes) each slot then holds.
+  // Returns true on success, false if some bucket cannot be placed.
+  static bool findPilots(const std::vector<uint64_t> &hashes, uint64_t numBuckets,
+                         std::vector<uint32_t> &pilotValues, std::vector<uint32_t> &slotWord);
+
+  // Point the section pointers into an image, checking that the
+  // sections, and every word, fit inside it. Returns true if they do.
+  bool attach(const unsigned char *base, size_t length);
+
+  // Release the image.
+  void close();
+};
+
+#endif //_PERFECT_DICT_H
@@ -1,104 +1,606 @@
 #include "hash.h"
+#include "dictIndex.h"
+#include "outputBuffer.h"
+#include "inputReader.h"
+#include "bloomFilter.h"
+#include "perfectDict.h"
+#include "suggester.h"
 
 #include <iostream>
-#include <fstream>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <ctime>
+#include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
-// Initial dictionary size of a large prime # and max word length of 20
+// Initial dictionary size (hashTable rounds it up to a power of two) and max word length of 20
 const int DICT_SIZE = 200000;
 const int MAX_WORD_LENGTH = 20;
 
+// How to take requests when running as a service rather than checking one document
+struct serviceOptions {
+    bool enabled = false;
+    std::string socketPath; // A Unix socket to listen on; empty to use stdin and stdout
+};
+
+// Suggestions to report with each unknown word; none unless pSuggester is set
+struct suggestOptions {
+    const suggester *pSuggester = nullptr;
+    int count = 0; // Suggestions per word
+    std::chrono::microseconds budget {1000}; // Time allowed per word
+};
+
 // Function to load words from a dictionary file into a hash table
-hashTable loadDictionary(const std::string &dictionaryFile) {
-    std::ifstream input(dictionaryFile);
+// If pFilter is provided, a Bloom filter over the words is built into it, sized by
+// its false-positive rate or, if bitsPerKey is positive, by its memory
+hashTable loadDictionary(const std::string &dictionaryFile, bloomFilter *pFilter = nullptr,
+                         double falsePositiveRate = 0.01, double bitsPerKey = 0) {
+    inputReader input;
+    input.open(dictionaryFile);
+    std::string_view line;
     std::string word;
     hashTable dictionary(DICT_SIZE);
     // Read each word from the dictionary file, convert to lowercase, and insert into hash table
-    while (getline(input, word)) {
+    while (input.getLine(line)) {
+        word.assign(line.data(), line.size());
         std::transform(word.begin(), word.end(), word.begin(), ::tolower);
         dictionary.insert(word);
     }
+    if (pFilter) {
+        *pFilter = bloomFilter(dictionary.size(), falsePositiveRate, bitsPerKey);
+        dictionary.forEach([pFilter](std::string_view key, void *) { pFilter->insert(key); });
+    }
     return dictionary;
 }
 
-// Function to check if a character is a valid letter, dash, or apostrophe
-bool isValidCharacter(char c) {
-    return (c >= 'a' && c <= 'z') || (c == '-') || (c == '\'');
-}
+// A dictionary behind a Bloom filter
+// Most unknown words are rejected by the filter, touching one cache line, without
+// probing the dictionary; known words pay for the filter check as well
+template <typename Dictionary>
+struct filteredDictionary {
+    const bloomFilter &filter;
+    Dictionary &dictionary;
 
-// Function to check if a character is a number
-bool isNumber(char c) {
-    return c >= '0' && c <= '9';
-}
+    bool contains(std::string_view word) {
+        return filter.mayContain(word) && dictionary.contains(word);
+    }
+};
+
+// Character classes used by the tokenizer; a class may combine several flags
+enum charClass : unsigned char {
+    SEPARATOR = 0, // Ends the current word
+    WORD_CHAR = 1, // A letter, dash, or apostrophe
+    DIGIT = 2, // A number; words containing one are not checked
+    UPPER = 4 // A capital letter, which is lowercased before lookup
+};
 
-// Function to spell check a single line of text
-void spellCheckLine(const std::string &inputLine, int lineNum, hashTable &dictionary, std::ofstream &output) {
-    std::string line = inputLine + " ";
-    std::string currentWord;
-    bool containsNumber = false;
-    // Iterate through each character in the line
-    for (char c : line) {
-        if (isValidCharacter(c) || isNumber(c)) {
-            currentWord += c;
-            if (isNumber(c)) {
-                containsNumber = true;
+// Lookup tables indexed by byte value, filled in at compile time
+// lower maps A-Z to a-z and leaves every other byte alone, as ::tolower does
+struct charTables {
+    unsigned char cls[256];
+    char lower[256];
+
+    constexpr charTables() : cls(), lower() {
+        for (int c = 0; c < 256; c++) {
+            // Bytes of 0x80 and up are separators, as in plain ASCII
+            // text; test the range, since char may be signed
+            lower[c] = (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+            if (c >= 'A' && c <= 'Z') {
+                cls[c] = WORD_CHAR | UPPER;
+            } else if ((c >= 'a' && c <= 'z') || c == '-' || c == '\'') {
+                cls[c] = WORD_CHAR;
+            } else if (c >= '0' && c <= '9') {
+                cls[c] = DIGIT;
+            } else {
+                cls[c] = SEPARATOR;
+            }
+        }
+    }
+};
+
+static constexpr charTables CHAR_TABLES;
+
+// Function to spell check a single line of text in [begin, end)
+// Words are looked up as views into the line; only a word with capitals is copied,
+// lowercased, into a small buffer on the stack
+// Dictionary is a hashTable or a memory-mapped dictIndex
+template <typename Dictionary>
+void spellCheckLine(const char *begin, const char *end, int lineNum, Dictionary &dictionary, outputBuffer &output,
+                    const suggestOptions &suggest) {
+    const char *p = begin;
+    char lowered[MAX_WORD_LENGTH];
+    while (p < end) {
+        // Skip to the start of the next word
+        while (p < end && CHAR_TABLES.cls[static_cast<unsigned char>(*p)] == SEPARATOR) {
+            p++;
+        }
+        if (p == end) {
+            break;
+        }
+        const char *wordStart = p;
+        unsigned char classes = 0;
+        for (; p < end; p++) {
+            unsigned char cls = CHAR_TABLES.cls[static_cast<unsigned char>(*p)];
+            if (cls == SEPARATOR) {
+                break;
+            }
+            classes |= cls;
+        }
+        size_t wordLength = p - wordStart;
+        const char *text = wordStart;
+        // No more than MAX_WORD_LENGTH characters of a word are ever looked up or printed
+        if (classes & UPPER) {
+            size_t n = std::min(wordLength, static_cast<size_t>(MAX_WORD_LENGTH));
+            for (size_t i = 0; i < n; i++) {
+                lowered[i] = CHAR_TABLES.lower[static_cast<unsigned char>(wordStart[i])];
             }
-        } else {
-            // Handle long words and unknown words without numbers
-            // Unknown words with numbers are valid, but ignored
-            if (currentWord.length() > MAX_WORD_LENGTH) {
-                output << "Long word at line " << lineNum << ", starts: " << currentWord.substr(0, MAX_WORD_LENGTH) << std::endl;
-            } else if (!containsNumber && !dictionary.contains(currentWord) && !currentWord.empty()) {
-                output << "Unknown word at line " << lineNum << ": " << currentWord << std::endl;
+            text = lowered;
+        }
+        // Handle long words and unknown words without numbers
+        // Unknown words with numbers are valid, but ignored
+        // Reports end in '\n' rather than std::endl, so they are not flushed one by one
+        if (wordLength > MAX_WORD_LENGTH) {
+            output << "Long word at line " << lineNum << ", starts: " << std::string_view(text, MAX_WORD_LENGTH) << '\n';
+        } else if (!(classes & DIGIT) && !dictionary.contains(std::string_view(text, wordLength))) {
+            output << "Unknown word at line " << lineNum << ": " << std::string_view(text, wordLength);
+            if (suggest.pSuggester) {
+                const char *separator = ", suggestions: ";
+                for (const auto &s : suggest.pSuggester->suggest(std::string_view(text, wordLength), suggest.count, suggest.budget)) {
+                    output << separator << s.word;
+                    separator = ", ";
+                }
             }
-            currentWord = "";
-            containsNumber = false;
+            output << '\n';
         }
     }
 }
 
 
 // Function to spell check an entire document
-void spellCheckDocument(const std::string &inputFile, const std::string &outputFile, hashTable &dictionary) {
-    std::ifstream input(inputFile);
-    std::ofstream output(outputFile);
-    std::string line;
+// Returns false if the input file cannot be read or the output file cannot be written
+template <typename Dictionary>
+bool spellCheckDocument(const std::string &inputFile, const std::string &outputFile, Dictionary &dictionary,
+                        const suggestOptions &suggest) {
+    inputReader input;
+    bool opened = input.open(inputFile);
+    outputBuffer output;
+    output.open(outputFile);
+    std::string_view line;
     int lineNum = 1;
-    // Process each line of the input file
-    while (getline(input, line)) {
-        // Convert all capital letters to lowercase
-        std::transform(line.begin(), line.end(), line.begin(), ::tolower);
-        spellCheckLine(line, lineNum, dictionary, output);
+    // Process each line of the input file; lines are views into the mapped file
+    while (input.getLine(line)) {
+        spellCheckLine(line.data(), line.data() + line.size(), lineNum, dictionary, output, suggest);
         lineNum++;
     }
+    return opened && output.close();
 }
 
-int main() {
-    clock_t startDictTime, endDictTime, startCheckTime, endCheckTime;
-    double timeElapsed;
-    std::string dictionaryFile, inputFile, outputFile;
-    // Get input for dictionary, input, and output files
-    std::cout << "Enter name of dictionary: ";
-    std::cin >> dictionaryFile;
-    // Measure time taken to load dictionary into hash table
-    startDictTime = clock();
+// Function to spell check the lines in [begin, end), numbering them from firstLine
+template <typename Dictionary>
+void spellCheckChunk(const char *begin, const char *end, int firstLine, Dictionary &dictionary, outputBuffer &output,
+                     const suggestOptions &suggest) {
+    int lineNum = firstLine;
+    // Split lines the way getline does: a final line without a newline still counts
+    while (begin < end) {
+        const char *newline = static_cast<const char *>(memchr(begin, '\n', end - begin));
+        spellCheckLine(begin, newline ? newline : end, lineNum, dictionary, output, suggest);
+        lineNum++;
+        begin = newline ? newline + 1 : end;
+    }
+}
+
+// Function to spell check an entire document on several threads
+// The document is taken in large windows of whole lines. Each window is split into
+// chunks of whole lines, the chunks are checked in parallel against the shared
+// (read-only) dictionary, and their reports are written in line order, so the
+// output is the same as spellCheckDocument's
+template <typename Dictionary>
+void spellCheckDocumentParallel(const std::string &inputFile, const std::string &outputFile, Dictionary &dictionary,
+                                const suggestOptions &suggest, int numThreads) {
+    const size_t CHUNK_SIZE = 1 << 20;
+    const size_t WINDOW_SIZE = CHUNK_SIZE * 4 * numThreads;
+    inputReader input;
+    input.open(inputFile);
+    outputBuffer output;
+    output.open(outputFile);
+    std::string_view window;
+    int lineNum = 1;
+    while (input.getLines(window, WINDOW_SIZE)) {
+        // Split the window into chunks ending on line boundaries
+        size_t usable = window.size();
+        std::vector<size_t> bounds = {0};
+        while (bounds.back() < usable) {
+            size_t next = bounds.back() + CHUNK_SIZE;
+            if (next >= usable) {
+                next = usable;
+            } else {
+                const char *newline = static_cast<const char *>(memchr(window.data() + next, '\n', usable - next));
+                next = newline ? newline - window.data() + 1 : usable;
+            }
+            bounds.push_back(next);
+        }
+        int numChunks = bounds.size() - 1;
+        // Each chunk's first line number follows from the newlines before it
+        std::vector<int> firstLines(numChunks);
+        for (int i = 0; i < numChunks; i++) {
+            firstLines[i] = lineNum;
+            lineNum += std::count(window.data() + bounds[i], window.data() + bounds[i + 1], '\n');
+        }
+        // Workers take chunks in order until none are left
+        // Each chunk's report is kept in memory until the chunks before it are written
+        std::vector<outputBuffer> reports(numChunks);
+        std::atomic<int> nextChunk(0);
+        auto worker = [&]() {
+            for (int i = nextChunk++; i < numChunks; i = nextChunk++) {
+                spellCheckChunk(window.data() + bounds[i], window.data() + bounds[i + 1], firstLines[i], dictionary, reports[i], suggest);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; t++) {
+            threads.emplace_back(worker);
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (auto &report : reports) {
+            output << report.view();
+        }
+    }
+}
+
+// A stream of requests, one per line, and where their replies go
+// Several workers may share one stream, so reading and replying are locked
+struct requestStream {
+    inputReader requests;
+    int replyFd;
+    std::mutex requestLock, replyLock;
+};
+
+// Latencies of the requests served so far, in microseconds
+struct serviceStats {
+    std::atomic<long> count {0}, total {0}, max {0};
+
+    void add(long latency) {
+        count++;
+        total += latency;
+        long seen = max;
+        while (latency > seen && !max.compare_exchange_weak(seen, latency)) {
+        }
+    }
+};
+
+// Function to write a whole reply, retrying after partial writes
+bool writeReply(int fd, std::string_view reply) {
+    while (!reply.empty()) {
+        ssize_t n = write(fd, reply.data(), reply.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        reply.remove_prefix(n);
+    }
+    return true;
+}
+
+// Function to answer the requests of a stream until it ends
+// A request is "<input file> <output file>"; the reply is
+// "ok <input file> <output file> <microseconds>", or "error ..." with the
+// same fields if a file could not be read or written
+template <typename Dictionary>
+void serveRequests(requestStream &stream, Dictionary &dictionary, const suggestOptions &suggest, serviceStats &stats) {
+    std::string request;
+    std::string_view line;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(stream.requestLock);
+            if (!stream.requests.getLine(line)) {
+                return;
+            }
+            request.assign(line.data(), line.size());
+        }
+        if (request.empty()) {
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        size_t space = request.find(' ');
+        bool ok = space != std::string::npos
+            && spellCheckDocument(request.substr(0, space), request.substr(space + 1), dictionary, suggest);
+        long latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        stats.add(latency);
+        // The reply is built in memory, then written whole
+        outputBuffer reply;
+        reply << (ok ? "ok " : "error ") << request << ' ' << latency << '\n';
+        std::lock_guard<std::mutex> lock(stream.replyLock);
+        writeReply(stream.replyFd, reply.view());
+    }
+}
+
+// Function to listen on a Unix socket, replacing any stale socket file
+// Returns the listening descriptor, or -1 on failure
+int listenOnSocket(const std::string &socketPath) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    unlink(socketPath.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1 || listen(fd, SOMAXCONN) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Function to serve spell check requests against a dictionary loaded once
+// On stdin, the workers share the one stream of requests and reply on stdout,
+// and the service ends with the input. On a socket, each worker accepts a
+// connection and answers its requests until the client closes it; the service
+// runs until it is killed
+template <typename Dictionary>
+int serveSpellCheck(Dictionary &dictionary, const suggestOptions &suggest, const serviceOptions &service, int numWorkers) {
+    // A client closing early must not kill the service
+    signal(SIGPIPE, SIG_IGN);
+    serviceStats stats;
+    std::vector<std::thread> workers;
+    if (service.socketPath.empty()) {
+        requestStream stream;
+        stream.requests.open(dup(STDIN_FILENO));
+        stream.replyFd = STDOUT_FILENO;
+        for (int i = 0; i < numWorkers; i++) {
+            workers.emplace_back([&]() { serveRequests(stream, dictionary, suggest, stats); });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        std::cerr << "Served " << stats.count << " requests, mean latency "
+                  << (stats.count ? stats.total / stats.count : 0) << " us, max " << stats.max << " us" << std::endl;
+        return 0;
+    }
+    int listener = listenOnSocket(service.socketPath);
+    if (listener == -1) {
+        std::cerr << "Error, could not listen on " << service.socketPath << std::endl;
+        return 1;
+    }
+    std::cerr << "Listening on " << service.socketPath << " with " << numWorkers << " workers" << std::endl;
+    for (int i = 0; i < numWorkers; i++) {
+        workers.emplace_back([&]() {
+            while (true) {
+                int connection = accept(listener, nullptr, nullptr);
+                if (connection == -1) {
+                    if (errno == EINTR || errno == ECONNABORTED) {
+                        continue;
+                    }
+                    return;
+                }
+                requestStream stream;
+                stream.replyFd = connection;
+                // The reader owns the connection and closes it when the stream goes
+                stream.requests.open(connection);
+                serveRequests(stream, dictionary, suggest, stats);
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    close(listener);
+    return 1;
+}
+
+// Function to build an index file that later runs can map instead of loading the dictionary
+int buildIndex(const std::string &dictionaryFile, const std::string &indexFile) {
     hashTable dictionary = loadDictionary(dictionaryFile);
-    endDictTime = clock();
-    // Calculate time elapsed to load dictionary
-    timeElapsed = static_cast<double>(endDictTime - startDictTime) / CLOCKS_PER_SEC;
-    std::cout << "Total time (in seconds) to load dictionary: " << timeElapsed << std::endl;
+    if (!dictIndex::build(dictionary, indexFile)) {
+        std::cerr << "Error, could not write index file " << indexFile << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote index of " << dictionary.size() << " words to " << indexFile << std::endl;
+    return 0;
+}
+
+// Function to build a perfect hash dictionary file that later runs can map
+int buildPerfect(const std::string &dictionaryFile, const std::string &perfectFile) {
+    perfectDict dictionary;
+    hashTable words = loadDictionary(dictionaryFile);
+    if (!dictionary.build(words)) {
+        std::cerr << "Error, could not build perfect hash dictionary from " << dictionaryFile << std::endl;
+        return 1;
+    }
+    if (!dictionary.save(perfectFile)) {
+        std::cerr << "Error, could not write perfect hash dictionary " << perfectFile << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote perfect hash dictionary of " << dictionary.size() << " words ("
+              << dictionary.memoryBytes() << " bytes) to " << perfectFile << std::endl;
+    return 0;
+}
+
+// Function to load a word list and build a perfect hash dictionary from it,
+// and the suggestion index too if pSuggester is set
+// The hash table is only needed while building, so it is freed on return
+bool loadPerfectDictionary(const std::string &dictionaryFile, perfectDict &dictionary, bloomFilter *pFilter,
+                           double falsePositiveRate, double bitsPerKey, suggester *pSuggester) {
+    hashTable words = loadDictionary(dictionaryFile, pFilter, falsePositiveRate, bitsPerKey);
+    if (pSuggester) {
+        pSuggester->build(words);
+    }
+    return dictionary.build(words);
+}
+
+// Function to ask for the input and output files and spell check them,
+// or to serve requests on numThreads workers when running as a service
+template <typename Dictionary>
+int runSpellCheck(Dictionary &dictionary, const suggestOptions &suggest, const serviceOptions &service, int numThreads) {
+    if (service.enabled) {
+        return serveSpellCheck(dictionary, suggest, service, numThreads);
+    }
+    double timeElapsed;
+    std::string inputFile, outputFile;
     std::cout << "Enter name of input file: ";
     std::cin >> inputFile;
     std::cout << "Enter name of output file: ";
     std::cin >> outputFile;
-    // Measure time taken to spell check the input file
-    startCheckTime = clock();
-    spellCheckDocument(inputFile, outputFile, dictionary);
-    endCheckTime = clock();
+    // Measure wall-clock time taken to spell check the input file
+    // (clock() would add up the CPU time of every thread)
+    auto startCheckTime = std::chrono::steady_clock::now();
+    if (numThreads > 1) {
+        spellCheckDocumentParallel(inputFile, outputFile, dictionary, suggest, numThreads);
+    } else {
+        spellCheckDocument(inputFile, outputFile, dictionary, suggest);
+    }
+    auto endCheckTime = std::chrono::steady_clock::now();
     // Calculate time elapsed for spell checking
-    timeElapsed = static_cast<double>(endCheckTime - startCheckTime) / CLOCKS_PER_SEC;
+    timeElapsed = std::chrono::duration<double>(endCheckTime - startCheckTime).count();
     std::cout << "Total time (in seconds) to check document: " << timeElapsed << std::endl;
     return 0;
 }
+
+// Function to spell check against the dictionary, behind the Bloom filter if there is one
+template <typename Dictionary>
+int runSpellCheck(Dictionary &dictionary, const bloomFilter *pFilter, const suggestOptions &suggest,
+                  const serviceOptions &service, int numThreads) {
+    if (pFilter) {
+        // A service replies on stdout, so its messages go to stderr
+        (service.enabled ? std::cerr : std::cout) << "Bloom filter: " << pFilter->memoryBytes() << " bytes, "
+                                                  << pFilter->hashCount() << " bits set per word" << std::endl;
+        filteredDictionary<Dictionary> filtered{*pFilter, dictionary};
+        return runSpellCheck(filtered, suggest, service, numThreads);
+    }
+    return runSpellCheck(dictionary, suggest, service, numThreads);
+}
+
+int main(int argc, char **argv) {
+    // Offline steps: spell.exe --build-index <dictionary> <index file>
+    // and spell.exe --build-perfect <dictionary> <perfect hash file>
+    if (argc == 4 && std::string(argv[1]) == "--build-index") {
+        return buildIndex(argv[2], argv[3]);
+    }
+    if (argc == 4 && std::string(argv[1]) == "--build-perfect") {
+        return buildPerfect(argv[2], argv[3]);
+    }
+    // spell.exe [--threads <n>] [--bloom <false-positive rate>] [--bloom-bits <bits per word>] [--perfect]
+    //           [--suggest <k>] [--suggest-budget <microseconds>]
+    // --threads checks the document on n threads
+    // --bloom and --bloom-bits put a Bloom filter in front of a word list dictionary
+    // --perfect turns a word list into a perfect hash dictionary after loading it
+    // --suggest lists up to k suggestions with each unknown word of a word list dictionary,
+    // spending at most --suggest-budget microseconds (default 1000) on each
+    // spell.exe --serve <dictionary> [--socket <path>] [options above]
+    // runs as a service that loads the dictionary once and checks many documents;
+    // see serveSpellCheck. --threads then sets the number of workers
+    int numThreads = 1;
+    suggestOptions suggest;
+    serviceOptions service;
+    std::string dictionaryFile;
+    bool useBloom = false, usePerfect = false;
+    double falsePositiveRate = 0.01, bitsPerKey = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--perfect") {
+            usePerfect = true;
+        } else if (option == "--threads" && i + 1 < argc) {
+            numThreads = std::max(1, atoi(argv[++i]));
+        } else if (option == "--bloom" && i + 1 < argc) {
+            useBloom = true;
+            falsePositiveRate = atof(argv[++i]);
+        } else if (option == "--bloom-bits" && i + 1 < argc) {
+            useBloom = true;
+            bitsPerKey = atof(argv[++i]);
+        } else if (option == "--suggest" && i + 1 < argc) {
+            suggest.count = atoi(argv[++i]);
+        } else if (option == "--suggest-budget" && i + 1 < argc) {
+            suggest.budget = std::chrono::microseconds(atol(argv[++i]));
+        } else if (option == "--serve" && i + 1 < argc) {
+            service.enabled = true;
+            dictionaryFile = argv[++i];
+        } else if (option == "--socket" && i + 1 < argc) {
+            service.socketPath = argv[++i];
+        }
+    }
+    suggester suggestions;
+    suggester *pSuggester = suggest.count > 0 ? &suggestions : nullptr;
+    clock_t startDictTime, endDictTime;
+    double timeElapsed;
+    // A service replies on stdout, so its messages go to stderr
+    std::ostream &log = service.enabled ? std::cerr : std::cout;
+    // Get input for dictionary, input, and output files
+    // The dictionary may be a word list, an index file built with --build-index,
+    // or a perfect hash dictionary built with --build-perfect
+    // Prebuilt dictionaries cannot list their words, so only word lists give suggestions
+    if (!service.enabled) {
+        std::cout << "Enter name of dictionary: ";
+        std::cin >> dictionaryFile;
+    }
+    if (dictIndex::isIndexFile(dictionaryFile)) {
+        // Map the prebuilt index; nothing is parsed or inserted
+        startDictTime = clock();
+        dictIndex dictionary;
+        if (!dictionary.open(dictionaryFile)) {
+            std::cerr << "Error, invalid index file " << dictionaryFile << std::endl;
+            return 1;
+        }
+        endDictTime = clock();
+        timeElapsed = static_cast<double>(endDictTime - startDictTime) / CLOCKS_PER_SEC;
+        log << "Total time (in seconds) to load dictionary: " << timeElapsed << std::endl;
+        return runSpellCheck(dictionary, suggest, service, numThreads);
+    }
+    if (perfectDict::isPerfectDictFile(dictionaryFile)) {
+        // Map the prebuilt perfect hash dictionary
+        startDictTime = clock();
+        perfectDict dictionary;
+        if (!dictionary.open(dictionaryFile)) {
+            std::cerr << "Error, invalid perfect hash dictionary " << dictionaryFile << std::endl;
+            return 1;
+        }
+        endDictTime = clock();
+        timeElapsed = static_cast<double>(endDictTime - startDictTime) / CLOCKS_PER_SEC;
+        log << "Total time (in seconds) to load dictionary: " << timeElapsed << std::endl;
+        return runSpellCheck(dictionary, suggest, service, numThreads);
+    }
+    bloomFilter filter;
+    bloomFilter *pFilter = useBloom ? &filter : nullptr;
+    if (usePerfect) {
+        startDictTime = clock();
+        perfectDict dictionary;
+        if (loadPerfectDictionary(dictionaryFile, dictionary, pFilter, falsePositiveRate, bitsPerKey, pSuggester)) {
+            endDictTime = clock();
+            timeElapsed = static_cast<double>(endDictTime - startDictTime) / CLOCKS_PER_SEC;
+            log << "Total time (in seconds) to load dictionary: " << timeElapsed << std::endl;
+            suggest.pSuggester = pSuggester;
+            return runSpellCheck(dictionary, pFilter, suggest, service, numThreads);
+        }
+        // The word list is loaded again below, which rebuilds the filter and suggestions too
+        std::cerr << "Warning, could not build perfect hash dictionary from " << dictionaryFile
+                  << "; using a hash table instead" << std::endl;
+    }
+    // Measure time taken to load dictionary into hash table
+    startDictTime = clock();
+    hashTable dictionary = loadDictionary(dictionaryFile, pFilter, falsePositiveRate, bitsPerKey);
+    if (pSuggester) {
+        pSuggester->build(dictionary);
+        suggest.pSuggester = pSuggester;
+    }
+    endDictTime = clock();
+    // Calculate time elapsed to load dictionary
+    timeElapsed = static_cast<double>(endDictTime - startDictTime) / CLOCKS_PER_SEC;
+    log << "Total time (in seconds) to load dictionary: " << timeElapsed << std::endl;
+    return runSpellCheck(dictionary, pFilter, suggest, service, numThreads);
+}
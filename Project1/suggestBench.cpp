@@ -0,0 +1,134 @@
+//
+// Benchmark for the spelling suggester.
+//
+// Loads the dictionary into a hashTable and builds the suggestion index,
+// reporting its build time and memory. It then makes misspellings of
+// random dictionary words (one or two random edits each) and times
+// suggest on them, with and without a per-word budget. A sample of the
+// misspellings is also checked against every dictionary word with a
+// plain dynamic-programming edit distance, to report the recall of the
+// index and its speedup over the exhaustive scan.
+//
+// Usage: suggestBench.exe [dictionary]
+// Without a dictionary, random words are generated.
+//
+
+#include "hash.h"
+#include "suggester.h"
+#include "benchUtil.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <unordered_set>
+
+// Apply one random substitution, insertion or deletion
+static void randomEdit(std::string &word, std::mt19937 &rng) {
+    char c = static_cast<char>(std::uniform_int_distribution<int>('a', 'z')(rng));
+    int op = word.empty() ? 1 : std::uniform_int_distribution<int>(0, 2)(rng);
+    size_t pos = std::uniform_int_distribution<size_t>(0, word.size() - (op != 1))(rng);
+    if (op == 0) {
+        word[pos] = c;
+    } else if (op == 1) {
+        word.insert(word.begin() + pos, c);
+    } else {
+        word.erase(pos, 1);
+    }
+}
+
+// Textbook dynamic-programming edit distance
+static int editDistance(const std::string &a, const std::string &b) {
+    std::vector<int> prev(b.size() + 1), cur(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); j++) {
+        prev[j] = j;
+    }
+    for (size_t i = 1; i <= a.size(); i++) {
+        cur[0] = i;
+        for (size_t j = 1; j <= b.size(); j++) {
+            cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + (a[i - 1] != b[j - 1])});
+        }
+        prev.swap(cur);
+    }
+    return prev[b.size()];
+}
+
+int main(int argc, char **argv) {
+    std::mt19937 rng(12345);
+    std::vector<std::string> dictionary = argc > 1 ? readDictionary(argv[1]) : randomWords(500000, rng);
+    hashTable table(0);
+    std::vector<std::string> words;
+    for (const auto &word : dictionary) {
+        if (table.insert(word) == 0) {
+            words.push_back(word);
+        }
+    }
+
+    suggester index;
+    auto start = std::chrono::steady_clock::now();
+    index.build(table);
+    double buildSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << index.size() << " dictionary words" << std::endl;
+    std::cout << "build: " << buildSecs << " s, " << index.memoryBytes() << " bytes ("
+              << static_cast<double>(index.memoryBytes()) / index.size() << " bytes/word)" << std::endl;
+
+    const int QUERIES = 20000;
+    std::uniform_int_distribution<size_t> pick(0, words.size() - 1);
+    std::vector<std::string> queries;
+    while (static_cast<int>(queries.size()) < QUERIES) {
+        std::string word = words[pick(rng)];
+        int edits = std::uniform_int_distribution<int>(1, 2)(rng);
+        for (int i = 0; i < edits; i++) {
+            randomEdit(word, rng);
+        }
+        if (!table.contains(word)) {
+            queries.push_back(word);
+        }
+    }
+
+    for (long budget : {0L, 1000L, 100L}) {
+        long found = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto &word : queries) {
+            found += index.suggest(word, 5, std::chrono::microseconds(budget)).size();
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "budget " << budget << " us: " << 1e6 * secs / QUERIES << " us/word ("
+                  << QUERIES / secs << " words/s), " << found << " suggestions" << std::endl;
+    }
+
+    // Recall within distance 2 against an exhaustive scan
+    const int SAMPLE = 200;
+    long expected = 0, missed = 0, wrongDistance = 0;
+    double scanSecs = 0, indexSecs = 0;
+    for (int q = 0; q < SAMPLE; q++) {
+        const std::string &word = queries[q];
+        start = std::chrono::steady_clock::now();
+        std::vector<std::string> near;
+        for (const auto &candidate : words) {
+            if (editDistance(word, candidate) <= 2) {
+                near.push_back(candidate);
+            }
+        }
+        auto middle = std::chrono::steady_clock::now();
+        auto found = index.suggest(word, words.size());
+        indexSecs += std::chrono::duration<double>(std::chrono::steady_clock::now() - middle).count();
+        scanSecs += std::chrono::duration<double>(middle - start).count();
+        std::unordered_set<std::string_view> got;
+        for (const auto &s : found) {
+            got.insert(s.word);
+            wrongDistance += editDistance(word, std::string(s.word)) != s.distance;
+        }
+        expected += near.size();
+        for (const auto &candidate : near) {
+            missed += !got.count(candidate);
+        }
+    }
+    std::cout << "recall: " << (expected ? 1.0 - static_cast<double>(missed) / expected : 1.0)
+              << " of " << expected << " words within distance 2, "
+              << wrongDistance << " wrong distances" << std::endl;
+    std::cout << "exhaustive scan: " << 1e3 * scanSecs / SAMPLE << " ms/word, index: "
+              << 1e3 * indexSecs / SAMPLE << " ms/word (" << scanSecs / indexSecs << "x)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include "suggester.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Add the hash of every string reachable by deleting up to depth more
+// characters at positions from start on, so each set of deleted
+// positions is generated once
+static void addDeletions(char *s, int length, int start, int depth, std::vector<uint64_t> &hashes) {
+    hashes.push_back(hashWyhash(s, length));
+    if (depth == 0) {
+        return;
+    }
+    char shorter[32];
+    for (int i = start; i < length; i++) {
+        memcpy(shorter, s, i);
+        memcpy(shorter + i, s + i + 1, length - i - 1);
+        addDeletions(shorter, length - 1, i, depth - 1, hashes);
+    }
+}
+
+// Deleting from a run of equal characters gives the same string more
+// than once, so the hashes are made distinct afterwards
+void suggester::deletionHashes(std::string_view word, std::vector<uint64_t> &hashes) const {
+    hashes.clear();
+    char prefix[MAX_PREFIX];
+    int length = std::min(static_cast<int>(word.size()), prefixLength);
+    memcpy(prefix, word.data(), length);
+    addDeletions(prefix, length, 0, maxDistance, hashes);
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+// Copy the words into the arena, then generate the deletions three
+// times: to size the buckets, to count the ids of each bucket, and to
+// place the ids, rather than holding every (hash, id) pair in memory
+void suggester::build(hashTable &dictionary, int maxDistance, int prefixLength) {
+    this->maxDistance = std::min(std::max(maxDistance, 1), 3);
+    this->prefixLength = std::min(std::max(prefixLength, this->maxDistance + 1), MAX_PREFIX);
+    arena.clear();
+    offsets.assign(1, 0);
+    dictionary.forEach([this](std::string_view key, void *) {
+        arena += key;
+        offsets.push_back(arena.size());
+    });
+    uint32_t numWords = offsets.size() - 1;
+
+    std::vector<uint64_t> hashes;
+    uint64_t numEntries = 0;
+    for (uint32_t id = 0; id < numWords; id++) {
+        deletionHashes(word(id), hashes);
+        numEntries += hashes.size();
+    }
+    // About two entries per bucket
+    bucketBits = 1;
+    while ((static_cast<uint64_t>(2) << bucketBits) < numEntries && bucketBits < 30) {
+        bucketBits++;
+    }
+    bucketStart.assign((static_cast<size_t>(1) << bucketBits) + 1, 0);
+    for (uint32_t id = 0; id < numWords; id++) {
+        deletionHashes(word(id), hashes);
+        for (uint64_t h : hashes) {
+            bucketStart[bucketOf(h) + 1]++;
+        }
+    }
+    for (size_t b = 1; b < bucketStart.size(); b++) {
+        bucketStart[b] += bucketStart[b - 1];
+    }
+    ids.assign(numEntries, 0);
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (uint32_t id = 0; id < numWords; id++) {
+        deletionHashes(word(id), hashes);
+        for (uint64_t h : hashes) {
+            ids[fill[bucketOf(h)]++] = id;
+        }
+    }
+}
+
+// Myers' bit-parallel algorithm in Hyyro's form for the edit distance of
+// the whole pattern against the whole text: bit i of pv and mv records
+// whether D[i][j] - D[i - 1][j] is +1 or -1 in the current column
+int suggester::myersDistance(const uint64_t *peq, int patternLength, std::string_view text) {
+    if (patternLength == 0) {
+        return text.size();
+    }
+    uint64_t pv = ~static_cast<uint64_t>(0);
+    uint64_t mv = 0;
+    uint64_t last = static_cast<uint64_t>(1) << (patternLength - 1);
+    int score = patternLength;
+    for (unsigned char c : text) {
+        uint64_t eq = peq[c];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) {
+            score++;
+        } else if (mh & last) {
+            score--;
+        }
+        // Row 0 of the matrix grows by one per text character
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score;
+}
+
+// Gather candidates from the buckets, check their distances, keep the best k
+std::vector<suggester::suggestion> suggester::suggest(std::string_view misspelled, int k,
+                                                       std::chrono::microseconds budget) const {
+    std::vector<suggestion> results;
+    if (misspelled.size() > 64 || k <= 0 || offsets.size() < 2) {
+        return results;
+    }
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    // The match vectors of the misspelled word
+    uint64_t peq[256] = {0};
+    int patternLength = misspelled.size();
+    for (int i = 0; i < patternLength; i++) {
+        peq[static_cast<unsigned char>(misspelled[i])] |= static_cast<uint64_t>(1) << i;
+    }
+    std::vector<uint64_t> hashes;
+    deletionHashes(misspelled, hashes);
+    std::vector<uint32_t> candidates;
+    for (uint64_t h : hashes) {
+        uint64_t b = bucketOf(h);
+        candidates.insert(candidates.end(), ids.begin() + bucketStart[b], ids.begin() + bucketStart[b + 1]);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        // Reading the clock is not free, so check the budget now and then
+        if (budget.count() > 0 && i % 64 == 63 && std::chrono::steady_clock::now() > deadline) {
+            break;
+        }
+        std::string_view candidate = word(candidates[i]);
+        // The distance is at least the difference in length
+        int lengthDiff = static_cast<int>(candidate.size()) - patternLength;
+        if (lengthDiff > maxDistance || -lengthDiff > maxDistance) {
+            continue;
+        }
+        int distance = myersDistance(peq, patternLength, candidate);
+        if (distance <= maxDistance) {
+            results.push_back({candidate, distance});
+        }
+    }
+    auto closer = [](const suggestion &a, const suggestion &b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.word < b.word;
+    };
+    if (static_cast<int>(results.size()) > k) {
+        std::partial_sort(results.begin(), results.begin() + k, results.end(), closer);
+        results.resize(k);
+    } else {
+        std::sort(results.begin(), results.end(), closer);
+    }
+    return results;
+}
+
+// The arena, the word offsets, the buckets and the ids
+size_t suggester::memoryBytes() const {
+    return arena.capacity() + offsets.capacity() * sizeof(uint32_t)
+        + bucketStart.capacity() * sizeof(uint32_t) + ids.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,86 @@
+#ifndef _SUGGESTER_H
+#define _SUGGESTER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "hash.h"
+
+//
+// suggester - spelling suggestions from a dictionary.
+//
+// Candidates come from a SymSpell-style symmetric deletion index: each
+// dictionary word is indexed under every string obtained by deleting
+// up to maxDistance characters from its first prefixLength characters.
+// A misspelled word generates the same deletions of its own prefix,
+// and the words indexed under them are the candidates. Each candidate
+// is then checked with Myers' bit-parallel Levenshtein distance, which
+// compares a word of up to 64 characters in one pass of word-sized
+// operations over the candidate.
+//
+// The index stores no deletion strings: a deletion's hash value picks
+// a bucket, and each bucket lists the ids of the words indexed under
+// it. Words sharing a bucket by chance only add candidates, which the
+// distance check rejects.
+//
+class suggester {
+
+ public:
+
+  // A suggested word and its edit distance from the misspelled word.
+  struct suggestion {
+    std::string_view word;
+    int distance;
+  };
+
+  // Build the index over every key of the hash table.
+  // Suggestions are at most maxDistance edits (1 to 3) away, and the
+  // first prefixLength characters (up to 16) of each word are indexed.
+  void build(hashTable &dictionary, int maxDistance = 2, int prefixLength = 7);
+
+  // Return up to k dictionary words closest to the word, nearest
+  // first, ties in alphabetical order. Candidates stop being examined
+  // once budget has passed (a zero budget means no limit), so a slow
+  // lookup returns the best suggestions found so far. Words longer
+  // than 64 characters get no suggestions.
+  std::vector<suggestion> suggest(std::string_view word, int k,
+                                  std::chrono::microseconds budget = std::chrono::microseconds(0)) const;
+
+  // The number of bytes the words and the index occupy.
+  size_t memoryBytes() const;
+
+  // The number of words in the index.
+  int size() const { return offsets.empty() ? 0 : static_cast<int>(offsets.size() - 1); }
+
+ private:
+
+  static constexpr int MAX_PREFIX = 16;
+
+  int maxDistance {2};
+  int prefixLength {7};
+  std::string arena; // Every word, back to back.
+  std::vector<uint32_t> offsets; // Word i is arena[offsets[i], offsets[i + 1]).
+  int bucketBits {0};
+  std::vector<uint32_t> bucketStart; // Bucket b lists ids[bucketStart[b], bucketStart[b + 1]).
+  std::vector<uint32_t> ids;
+
+  std::string_view word(uint32_t id) const {
+    return std::string_view(arena.data() + offsets[id], offsets[id + 1] - offsets[id]);
+  }
+
+  // The hash values of the distinct strings obtained by deleting up to
+  // maxDistance characters from the prefix of a word, itself included.
+  void deletionHashes(std::string_view word, std::vector<uint64_t> &hashes) const;
+
+  // The bucket a deletion's hash value belongs to.
+  uint64_t bucketOf(uint64_t hashVal) const { return bucketBits ? hashVal >> (64 - bucketBits) : 0; }
+
+  // Levenshtein distance between a pattern of at most 64 characters,
+  // given as its match vectors peq, and a text.
+  static int myersDistance(const uint64_t *peq, int patternLength, std::string_view text);
+};
+
+#endif //_SUGGESTER_H
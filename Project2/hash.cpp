@@ -4,155 +4,447 @@
 #include <cmath>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cstring>
 
-// Initializes hash table with a prime greater or equal to size
-hashTable::hashTable(int size) {
-    unsigned int primeSize = getPrime(size);
-    data.resize(primeSize);
-    capacity = primeSize;
-    filled = 0;
-    // Initialize each hash table slot as unoccupied and not deleted
-    for (auto& item : data) {
-        item.isOccupied = false;
-        item.isDeleted = false;
+// Initializes hash table with a power of two greater or equal to size
+hashTable::hashTable(int size, hashFunction kind, const hashPolicy &policy) : policy(policy) {
+    hashKey = getHashFunction(kind);
+    // Keep the policy within what probing relies on: at least one empty
+    // slot in every probe sequence, and power-of-two capacities of at
+    // least one group
+    this->policy.maxLoad = std::min(std::max(policy.maxLoad, 0.125), 0.875);
+    int growthFactor = 2;
+    while (growthFactor < policy.growthFactor && growthFactor < MAX_CAPACITY) {
+        growthFactor <<= 1;
     }
+    this->policy.growthFactor = growthFactor;
+    this->policy.minCapacity = std::min(std::max(policy.minCapacity, GROUP_WIDTH), MAX_CAPACITY);
+    capacity = capacityFor(size);
+    growAt = loadLimit(capacity);
+    // Every slot starts out empty, including the cloned control bytes
+    ctrl.assign(capacity + GROUP_WIDTH - 1, EMPTY);
+    keys.reset(new keySlot[capacity]);
+    values.reset(new void *[capacity]);
+    filled = 0;
 }
 
 // Inserts a key value pair into the hash table
-int hashTable::insert(const std::string &key, void *pv) {
-    // If more than half the slots are filled, rehash the table
-    if (static_cast<double>(filled) / capacity >= 0.5) {
-        if (!rehash()) {
-            // Return 2 for failed rehashing
-            return 2; 
+int hashTable::insert(std::string_view key, void *pv) {
+    bool inserted;
+    if (!findOrInsert(key, pv, &inserted)) {
+        // Return 2 for failed rehashing
+        return 2;
+    }
+    // Return 0 for success, 1 if key already exists
+    return inserted ? 0 : 1;
+}
+
+// Find the key, inserting it if it is missing, with a single probe
+void **hashTable::findOrInsert(std::string_view key, void *pv, bool *pInserted) {
+    // If the table is at its maximum load, grow it
+    if (filled >= growAt) {
+        int newCapacity = capacity <= MAX_CAPACITY / policy.growthFactor ? capacity * policy.growthFactor : MAX_CAPACITY;
+        if (newCapacity == capacity || !rehash(newCapacity)) {
+            return nullptr;
         }
     }
     // Find the slot for the key
-    int hashVal = hash(key);
-    while (data[hashVal].isOccupied) {
-        // If key already exists and is not deleted, return 1
-        if (data[hashVal].key == key && !data[hashVal].isDeleted) {
-            return 1;
-        }
-        // Linear probing to find the next slot
-        hashVal = (hashVal + 1) % capacity;
-    }
-    // Insert the key value pair into the hash table
-    data[hashVal].key = key;
-    data[hashVal].isOccupied = true;
-    data[hashVal].isDeleted = false;
-    data[hashVal].pv = pv;
+    uint64_t hashVal = hash(key);
+    int pos = -1;
+    int found = findPos(key, hashVal, &pos);
+    if (pInserted) {
+        *pInserted = (found == -1);
+    }
+    if (found != -1) {
+        return &values[found];
+    }
+    // Insert the key value pair into the empty slot the probe ended at
+    if (!storeKey(key, hashVal, keys[pos])) {
+        return nullptr;
+    }
+    setCtrl(pos, fingerprint(hashVal));
+    values[pos] = pv;
     filled++;
-    // Return 0 for success
-    return 0;
+    return &values[pos];
+}
+
+// Insert the key or replace its pointer
+int hashTable::insertOrAssign(std::string_view key, void *pv) {
+    bool inserted;
+    void **ppv = findOrInsert(key, pv, &inserted);
+    if (!ppv) {
+        // Return 2 for failed rehashing
+        return 2;
+    }
+    *ppv = pv;
+    return inserted ? 0 : 1;
+}
+
+// Return the address of the pointer associated with the key
+void **hashTable::find(std::string_view key) {
+    return const_cast<void **>(lookup(key));
 }
 
 // Check if the hash table contains a key
-bool hashTable::contains(const std::string &key) {
-    return findPos(key) != -1;
+bool hashTable::contains(std::string_view key) const {
+    return lookup(key) != nullptr;
 }
 
 // Computes a hash value for the given key
-// Hash function taken from Data Structures and Algorithms Analysis in C++ by Mark A. Weiss pg 195
-int hashTable::hash(const std::string &key) {
-    unsigned int hashVal = 0;
-    for (char ch: key)
-        hashVal = 37 * hashVal + ch;
-    return hashVal % capacity;
+uint64_t hashTable::hash(std::string_view key) const {
+    return hashKey(key.data(), key.size());
+}
+
+// Keep a short key in its slot, and append a long one to the arena
+bool hashTable::storeKey(std::string_view key, uint64_t hashVal, keySlot &k) {
+    if (key.size() <= INLINE_KEY) {
+        k.hashVal = hashVal;
+        k.length = key.size();
+        memcpy(k.bytes, key.data(), key.size());
+        return true;
+    }
+    if (arena.size() + key.size() > UINT32_MAX) {
+        return false;
+    }
+    try {
+        arena.insert(arena.end(), key.begin(), key.end());
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    k.hashVal = hashVal;
+    k.offset = arena.size() - key.size();
+    k.length = key.size();
+    return true;
+}
+
+// Give back the bytes of the last key added, or count them as garbage
+void hashTable::releaseKey(const keySlot &k) {
+    if (k.length <= INLINE_KEY) {
+        return;
+    }
+    if (k.offset + k.length == arena.size()) {
+        arena.resize(k.offset);
+    } else {
+        deadBytes += k.length;
+    }
+    if (deadBytes >= MIN_COMPACT_BYTES && deadBytes * 2 > arena.size()) {
+        compactKeys();
+    }
+}
+
+// Rebuild the arena from the occupied slots
+void hashTable::compactKeys() {
+    finishRehash();
+    std::vector<char> compacted;
+    compacted.reserve(arena.size() - deadBytes);
+    for (int i = 0; i < capacity; i++) {
+        if (isFull(ctrl[i]) && keys[i].length > INLINE_KEY) {
+            uint32_t offset = compacted.size();
+            compacted.insert(compacted.end(), arena.begin() + keys[i].offset,
+                             arena.begin() + keys[i].offset + keys[i].length);
+            keys[i].offset = offset;
+        }
+    }
+    arena = std::move(compacted);
+    deadBytes = 0;
+}
+
+// Set a control byte and its clone past the end of the table
+void hashTable::setCtrl(int pos, unsigned char c) {
+    ctrl[pos] = c;
+    if (pos < GROUP_WIDTH - 1) {
+        ctrl[capacity + pos] = c;
+    }
+}
+
+// Linear probing, one group of control bytes per iteration
+int hashTable::probe(const unsigned char *ctrl, const keySlot *keys, const char *arena, unsigned int mask,
+                     std::string_view key, uint64_t hashVal, int *pFree) {
+    unsigned char fp = fingerprint(hashVal);
+    int pos = hashVal & mask;
+    // A hit is usually in the home slot, so start fetching its key
+    // while the control bytes are loaded
+    __builtin_prefetch(&keys[pos]);
+    while (true) {
+        const unsigned char *group = &ctrl[pos];
+        unsigned int empty = ctrlGroup::match(group, EMPTY);
+        unsigned int candidates = ctrlGroup::match(group, fp);
+        // The probe sequence ends at the first empty slot, so ignore
+        // fingerprint matches beyond it
+        if (empty) {
+            candidates &= (empty & -empty) - 1;
+        }
+        while (candidates) {
+            int slot = (pos + __builtin_ctz(candidates)) & mask;
+            // The cached hash value rules out nearly every false match
+            // before the key bytes are read
+            const keySlot &k = keys[slot];
+            if (k.hashVal == hashVal && k.length == key.size()
+                && memcmp(k.data(arena), key.data(), key.size()) == 0) {
+                // Return the position of key if found
+                return slot;
+            }
+            candidates &= candidates - 1;
+        }
+        if (empty) {
+            if (pFree) {
+                *pFree = (pos + __builtin_ctz(empty)) & mask;
+            }
+            // Return -1 if key not found
+            return -1;
+        }
+        // Move on to the next group
+        pos = (pos + GROUP_WIDTH) & mask;
+    }
+}
+
+// Find the first empty slot from the home slot of a hash value
+int hashTable::findEmpty(uint64_t hashVal) {
+    unsigned int mask = capacity - 1;
+    int pos = hashVal & mask;
+    unsigned int empty;
+    while (!(empty = ctrlGroup::match(&ctrl[pos], EMPTY))) {
+        pos = (pos + GROUP_WIDTH) & mask;
+    }
+    return (pos + __builtin_ctz(empty)) & mask;
+}
+
+// Probe the current arrays, then any old ones, moving nothing
+void *const *hashTable::lookup(std::string_view key) const {
+    uint64_t hashVal = hash(key);
+    int pos = probe(ctrl.data(), keys.get(), arena.data(), capacity - 1, key, hashVal);
+    if (pos != -1) {
+        return &values[pos];
+    }
+    if (oldCapacity) {
+        pos = probe(oldCtrl.data(), oldKeys.get(), arena.data(), oldCapacity - 1, key, hashVal);
+        if (pos != -1) {
+            return &oldValues[pos];
+        }
+    }
+    return nullptr;
 }
 
 // Finds the position of the key in the hash table
-int hashTable::findPos(const std::string &key) {
-    int pos = hash(key);
-    while (data[pos].isOccupied) {
-        if (data[pos].key == key && !data[pos].isDeleted) {
-            // Return the position of key if found
-            return pos;
+int hashTable::findPos(std::string_view key, uint64_t hashVal, int *pFree) {
+    if (oldCapacity) {
+        // Every operation moves some of the old slots along
+        migrate(MIGRATE_STEP);
+        if (oldCapacity) {
+            int oldPos = probe(oldCtrl.data(), oldKeys.get(), arena.data(), oldCapacity - 1, key, hashVal);
+            if (oldPos != -1) {
+                return moveOldSlot(oldPos);
+            }
         }
-        // Linear probing to find the next slot
-        pos = (pos + 1) % capacity;
     }
-    // Return -1 if key not found
-    return -1;
+    return probe(ctrl.data(), keys.get(), arena.data(), capacity - 1, key, hashVal, pFree);
+}
+
+int hashTable::findPos(std::string_view key) {
+    return findPos(key, hash(key));
+}
+
+// Place an item by its cached hash value; its key stays where it is in the arena
+int hashTable::place(const keySlot &k, void *pv) {
+    int pos = findEmpty(k.hashVal);
+    setCtrl(pos, fingerprint(k.hashVal));
+    keys[pos] = k;
+    values[pos] = pv;
+    return pos;
+}
+
+// Move an item from the old arrays into the current ones
+int hashTable::moveOldSlot(int oldPos) {
+    // The item cannot already be in the current arrays, so it goes in
+    // the first empty slot without comparing keys
+    int pos = place(oldKeys[oldPos], oldValues[oldPos]);
+    oldCtrl[oldPos] = MOVED;
+    if (oldPos < GROUP_WIDTH - 1) {
+        oldCtrl[oldCapacity + oldPos] = MOVED;
+    }
+    return pos;
+}
+
+// Move the next count old slots into the current arrays
+void hashTable::migrate(int count) {
+    int end = std::min(migratePos + count, oldCapacity);
+    for (; migratePos < end; migratePos++) {
+        if (isFull(oldCtrl[migratePos])) {
+            moveOldSlot(migratePos);
+        }
+    }
+    // Release the old arrays once every slot has moved
+    if (migratePos == oldCapacity) {
+        std::vector<unsigned char>().swap(oldCtrl);
+        oldKeys.reset();
+        oldValues.reset();
+        oldCapacity = 0;
+        migratePos = 0;
+    }
+}
+
+// Choose between stop-the-world and incremental rehashing
+void hashTable::setIncrementalRehash(bool on) {
+    if (!on) {
+        finishRehash();
+    }
+    policy.incrementalRehash = on;
+}
+
+// Move all remaining old slots
+void hashTable::finishRehash() {
+    if (oldCapacity) {
+        migrate(oldCapacity);
+    }
 }
 
 // Resize and rehash the table
-bool hashTable::rehash() {
-    int newCapacity = getPrime(capacity);
-    std::vector<hashItem> tempVector = std::move(data);
+bool hashTable::rehash(int newCapacity) {
+    // An incremental rehash still in progress is finished first
+    finishRehash();
+    std::vector<unsigned char> newCtrl;
+    std::unique_ptr<keySlot[]> newKeys;
+    std::unique_ptr<void *[]> newValues;
     try {
-        data.resize(newCapacity);
+        newCtrl.assign(newCapacity + GROUP_WIDTH - 1, EMPTY);
+        newKeys.reset(new keySlot[newCapacity]);
+        newValues.reset(new void *[newCapacity]);
     } catch (const std::bad_alloc&) {
-        // Return false on failed rehash
+        // Return false on failed rehash, leaving the table as it was
         return false;
     }
+    std::vector<unsigned char> prevCtrl = std::move(ctrl);
+    std::unique_ptr<keySlot[]> prevKeys = std::move(keys);
+    std::unique_ptr<void *[]> prevValues = std::move(values);
+    int prevCapacity = capacity;
+    ctrl = std::move(newCtrl);
+    keys = std::move(newKeys);
+    values = std::move(newValues);
     capacity = newCapacity;
-    filled = 0;
-    // Reinsert old items into the resized hash table
-    for (const auto& item : tempVector) {
-        if (item.isOccupied && !item.isDeleted) {
-            insert(item.key, item.pv);
+    growAt = loadLimit(capacity);
+    if (policy.incrementalRehash) {
+        // Keep the previous arrays as the old ones, and move a few of
+        // their slots along with each later insert or remove
+        oldCtrl = std::move(prevCtrl);
+        oldKeys = std::move(prevKeys);
+        oldValues = std::move(prevValues);
+        oldCapacity = prevCapacity;
+        migratePos = 0;
+        return true;
+    }
+    // Move every item now. The keys are distinct and their hash values
+    // are cached, so each one goes straight to its slot: no key is
+    // hashed, compared or copied, and nothing is marked as moved
+    for (int i = 0; i < prevCapacity; i++) {
+        if (isFull(prevCtrl[i])) {
+            place(prevKeys[i], prevValues[i]);
         }
     }
     return true;
 }
 
-// Obtain prime number greater or equal to size
-unsigned int hashTable::getPrime(int size) {
-    static const std::vector<int> primes = {
-        101039, 202079, 404113, 808217, 1616437, 3232877, 6465767, 12931529, 25863059, 
-        51726121, 103452249, 206904483, 413809041, 827618087, 1655236173
-    };
-    for (int prime : primes) {
-        if (prime > size) {
-            return prime;
-        }
+// Obtain a power of two greater or equal to size and the minimum capacity
+int hashTable::capacityFor(int size) const {
+    int newCapacity = GROUP_WIDTH;
+    while ((newCapacity < size || newCapacity < policy.minCapacity) && newCapacity < MAX_CAPACITY) {
+        newCapacity <<= 1;
     }
-    // Return the largest prime number if size is bigger than all primes
-    return primes.back();
+    return newCapacity;
+}
+
+// Grow until n items fit under the maximum load
+bool hashTable::reserve(int n) {
+    int newCapacity = capacity;
+    while (loadLimit(newCapacity) < n && newCapacity < MAX_CAPACITY) {
+        newCapacity <<= 1;
+    }
+    return newCapacity == capacity || rehash(newCapacity);
 }
 
 // Get the pointer associated with the specified key
-void *hashTable::getPointer(const std::string &key, bool *b) {
-    int pos = findPos(key);
+void *hashTable::getPointer(std::string_view key, bool *b) const {
+    void *const *ppv = lookup(key);
     // If b is provided, return true if key is in hashtable, false otherwise
     if (b != nullptr) {
-        if (pos != -1) {
+        if (ppv != nullptr) {
             *b = true;
         } else {
             *b = false;
         }
     }
     // If key does not exist in the hashtable, return nullptr
-    if (pos == -1) {
+    if (ppv == nullptr) {
         return nullptr;
     }
     // Otherwise, return pointer associated with key
-    void* pointerValue = data[pos].pv;
+    void* pointerValue = *ppv;
     return pointerValue;
 }
 
-// Set the pointer associated with the specified key
-int hashTable::setPointer(const std::string &key, void *pv) {
-    int pos = findPos(key);
-    if (pos == -1) {
+// Set the pointer associated with the specified key, wherever it is
+int hashTable::setPointer(std::string_view key, void *pv) {
+    void **ppv = find(key);
+    if (ppv == nullptr) {
         // Return 1 if key does not exist in the hash table
         return 1;
     }
-    data[pos].pv = pv;
+    *ppv = pv;
     // Return 0 on success
     return 0;
 }
 
 // Delete the item with the specified key
-bool hashTable::remove(const std::string &key) {
+bool hashTable::remove(std::string_view key) {
     int pos = findPos(key);
     // Return false if the key does not exist in the hash table
     if (pos == -1) {
         return false;
     }
-    data[pos].isOccupied = false;
-    data[pos].isDeleted = true;
-    //  Return true on success
+    // Backward-shift deletion: pull later entries of the cluster into
+    // the hole, so no tombstone is left behind to lengthen probes
+    keySlot removed = keys[pos];
+    unsigned int mask = capacity - 1;
+    int hole = pos;
+    for (int next = (hole + 1) & mask; isFull(ctrl[next]); next = (next + 1) & mask) {
+        int home = keys[next].hashVal & mask;
+        // The entry may move back unless its home lies after the hole
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            setCtrl(hole, ctrl[next]);
+            keys[hole] = keys[next];
+            values[hole] = values[next];
+            hole = next;
+        }
+    }
+    setCtrl(hole, EMPTY);
+    values[hole] = nullptr;
+    filled--;
+    // Only now, as compacting may finish an incremental rehash
+    releaseKey(removed);
+    // Shrink once the load is well below the maximum, to where the
+    // table is half as full as it may get, so that a few inserts and
+    // removes around the threshold do not resize it back and forth
+    if (policy.shrinkOnRemove && filled < growAt / 4) {
+        int newCapacity = capacityFor(static_cast<int>(2 * filled / policy.maxLoad) + 1);
+        if (newCapacity < capacity) {
+            rehash(newCapacity);
+        }
+    }
+    // Return true on success
     return true;
 }
+
+// Average distance from the home slot, counting the home slot itself
+double hashTable::averageProbeLength() {
+    finishRehash();
+    long total = 0;
+    int count = 0;
+    for (int i = 0; i < capacity; i++) {
+        if (isFull(ctrl[i])) {
+            int home = keys[i].hashVal & (capacity - 1);
+            total += ((i - home) & (capacity - 1)) + 1;
+            count++;
+        }
+    }
+    return count ? static_cast<double>(total) / count : 0;
+}
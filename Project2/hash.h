@@ -3,83 +3,302 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+#include "hashFunctions.h"
+#include "hashGroup.h"
+
+//
+// hashPolicy - how a hashTable sizes itself.
+//
+// A lower maximum load keeps probe sequences short at the cost of
+// memory; a higher one fits more items into the same slots. A small
+// minimum capacity suits the many small tables of a graph or heap, a
+// large one saves the early rehashes of a table known to grow big.
+// Values out of range are clamped when the table is constructed.
+//
+struct hashPolicy {
+  double maxLoad = 0.5; // Grow once this fraction of the slots is filled (0.125 to 0.875).
+  int growthFactor = 2; // Growing multiplies the capacity by this, rounded up to a power of two.
+  int minCapacity = 16; // The table never has fewer slots (nor fewer than one probe group).
+  bool shrinkOnRemove = false; // Shrink once removes bring the load below maxLoad / 4.
+  bool incrementalRehash = false; // Rehash incrementally; see setIncrementalRehash.
+};
 
 class hashTable {
 
  public:
 
   // The constructor initializes the hash table.
-  // Uses getPrime to choose a prime number at least as large as
-  // the specified size for the initial size of the hash table.
-  hashTable(int size = 0);
+  // Uses capacityFor to choose a power of two at least as large as
+  // the specified size (and the policy's minimum capacity) for the
+  // initial size of the hash table.
+  // Keys are hashed with the specified hash function, and the table
+  // grows and shrinks as the policy says.
+  // Every member function takes its key as a std::string_view, so a
+  // lookup by a view into a larger buffer builds no std::string; only
+  // an insert copies the key into the table.
+  // Short keys are kept in their slots and longer ones back to back in
+  // one arena, rather than as a std::string per slot, so inserting a
+  // key allocates nothing of its own, and a rehash moves fixed-size
+  // slots without touching the arena.
+  hashTable(int size = 0, hashFunction kind = hashFunction::wyhash, const hashPolicy &policy = hashPolicy());
 
   // Insert the specified key into the hash table.
   // If an optional pointer is provided,
   // associate that pointer with the key.
   // Returns 0 on success,
   // 1 if key already exists in hash table,
-  // 2 if rehash fails.
-  int insert(const std::string &key, void *pv = nullptr);
+  // 2 if rehash fails or the key storage is full (4 GB).
+  int insert(std::string_view key, void *pv = nullptr);
+
+  // Find the item with the specified key, inserting it with the
+  // specified pointer if it is not there yet. The key is hashed and
+  // probed for only once.
+  // Returns the address of the pointer associated with the key,
+  // or nullptr if rehash fails or the key storage is full.
+  // If pInserted is provided, write to that address true if the key
+  // was inserted by this call, and false if it already existed.
+  void **findOrInsert(std::string_view key, void *pv = nullptr, bool *pInserted = nullptr);
+
+  // Associate the specified pointer with the key, inserting the key
+  // if it does not exist yet.
+  // Returns 0 if the key was inserted,
+  // 1 if the key already existed and its pointer was replaced,
+  // 2 if rehash fails or the key storage is full.
+  int insertOrAssign(std::string_view key, void *pv);
+
+  // Return the address of the pointer associated with the specified
+  // key, or nullptr if the key does not exist in the hash table.
+  // The address stays valid until the next insert or remove.
+  void **find(std::string_view key);
 
   // Check if the specified key is in the hash table.
   // If so, return true; otherwise, return false.
-  bool contains(const std::string &key);
+  bool contains(std::string_view key) const;
 
   // Get the pointer associated with the specified key.
   // If the key does not exist in the hash table, return nullptr.
   // If an optional pointer to a bool is provided,
   // set the bool to true if the key is in the hash table,
   // and set the bool to false otherwise.
-  void *getPointer(const std::string &key, bool *b = nullptr);
+  void *getPointer(std::string_view key, bool *b = nullptr) const;
 
   // Set the pointer associated with the specified key.
   // Returns 0 on success,
   // 1 if the key does not exist in the hash table.
-  int setPointer(const std::string &key, void *pv);
+  int setPointer(std::string_view key, void *pv);
 
   // Delete the item with the specified key.
   // Returns true on success,
   // false if the specified key is not in the hash table.
-  bool remove(const std::string &key);
+  bool remove(std::string_view key);
+
+  // Choose how the table grows. By default a rehash moves every item
+  // at once. With incremental rehashing, the old and new slot arrays
+  // coexist after a rehash starts, and each later insert or remove
+  // moves a bounded number of old slots, so no single insert pays for
+  // all of it.
+  // In either mode, find, contains, getPointer and forEach never change
+  // the table (a lookup during an incremental rehash probes both slot
+  // arrays instead), so several threads may look up at once as long as
+  // none of them inserts, removes or sets a pointer.
+  void setIncrementalRehash(bool on);
+
+  // Finish any incremental rehash that is still in progress.
+  void finishRehash();
+
+  // Make room for n items in all, so that no insert rehashes until
+  // the table holds n items.
+  // Returns true on success, false if memory allocation fails.
+  bool reserve(int n);
+
+  // Return the number of slots in the hash table.
+  int getCapacity() const { return capacity; }
+
+  // Return the policy, as clamped by the constructor.
+  const hashPolicy &getPolicy() const { return policy; }
+
+  // Return the number of items in the hash table.
+  int size() const { return filled; }
+
+  // Call f(key, pv) for every item in the hash table.
+  // The key is a std::string_view into the table's key storage, valid
+  // until the next insert or remove.
+  template <typename F>
+  void forEach(F f) const {
+    for (int i = 0; i < capacity; i++) {
+      if (isFull(ctrl[i])) {
+        f(keyOf(keys[i]), values[i]);
+      }
+    }
+    // Items of an incremental rehash that have not moved yet
+    for (int i = 0; i < oldCapacity; i++) {
+      if (isFull(oldCtrl[i])) {
+        f(keyOf(oldKeys[i]), oldValues[i]);
+      }
+    }
+  }
+
+  // Return the average number of slots a successful lookup examines.
+  double averageProbeLength();
 
  private:
 
-  // Each item in the hash table contains:
-  // key - a string used as a key.
-  // isOccupied - if false, this entry is empty,
-  //              and the other fields are meaningless.
-  // isDeleted - if true, this item has been lazily deleted.
-  // pv - a pointer related to the key;
-  //      nullptr if no pointer was provided to insert.
-  class hashItem {
-  public:
-    std::string key {""};
-    bool isOccupied {false};
-    bool isDeleted {false};
-    void *pv {nullptr};
-
-    hashItem() = default;
+  // Slots are stored as parallel arrays rather than as one array of
+  // objects, so that a probe can scan the small control bytes and only
+  // touch a key when its fingerprint matches. For each slot:
+  // ctrl - EMPTY, or (for an occupied slot) a 7-bit fingerprint
+  //        of the key's hash value. Removal shifts later entries
+  //        back, so there are no deleted markers.
+  // keys - the slot's key, or where it lies in the arena, and the
+  //        key's full hash value; uninitialized unless occupied.
+  // values - a pointer related to the key;
+  //          nullptr if no pointer was provided to insert;
+  //          uninitialized unless occupied.
+  // Only the control bytes are initialized when the arrays are
+  // allocated, so growing the table writes each new slot only once.
+  static constexpr unsigned char EMPTY = ctrlGroup::EMPTY;
+
+  // Marks a slot of the old arrays whose item has already moved to the
+  // new ones during an incremental rehash. Lookups in the old arrays
+  // skip such slots rather than stopping at them.
+  static constexpr unsigned char MOVED = 0xFE;
+
+  // Lookups examine this many consecutive control bytes at a time.
+  // The first GROUP_WIDTH - 1 control bytes are cloned past the end of
+  // ctrl, so a group starting near the end never needs to wrap around.
+  static constexpr int GROUP_WIDTH = ctrlGroup::WIDTH;
+
+  // Keys this long or shorter are kept in their slot, not the arena.
+  static constexpr uint32_t INLINE_KEY = 12;
+
+  // A key, with its hash value cached so that rehashing, removal and
+  // key comparison need not read or hash the key again. A short key
+  // is kept in the slot itself, so a hit reads no memory beyond the
+  // control bytes and the slot; a longer one lies in the arena.
+  struct keySlot {
+    uint64_t hashVal;
+    uint32_t length;
+    union {
+      uint32_t offset; // Where a long key lies in the arena.
+      char bytes[INLINE_KEY]; // A short key's own bytes.
+    };
+
+    const char *data(const char *arena) const { return length <= INLINE_KEY ? bytes : arena + offset; }
   };
 
-  int capacity; // The current capacity of the hash table.
-  int filled; // Number of occupied items in the table.
+  int capacity; // The current capacity of the hash table (a power of two).
+  int filled; // Number of items in the table, in either slot array.
+  int growAt; // The table grows when an insert finds this many items.
+
+  hashPolicy policy;
 
-  std::vector<hashItem> data; // The actual entries are here.
+  // The largest capacity handed out.
+  static constexpr int MAX_CAPACITY = 1 << 30;
 
-  // The hash function.
-  int hash(const std::string &key);
+  std::vector<unsigned char> ctrl; // The control bytes are here.
+  std::unique_ptr<keySlot[]> keys; // Where the keys are.
+  std::unique_ptr<void *[]> values; // The associated pointers are here.
 
-  // Search for an item with the specified key.
+  // The bytes of every key, back to back. A removed key's bytes stay
+  // until garbage outweighs live keys, and then the arena is compacted.
+  std::vector<char> arena;
+  size_t deadBytes {0}; // Bytes of removed keys still in the arena.
+
+  // Keys are compacted only once the arena holds at least this much.
+  static constexpr size_t MIN_COMPACT_BYTES = 1 << 16;
+
+  hashFn hashKey; // The hash function chosen at construction.
+
+  // During an incremental rehash, the slot arrays being emptied.
+  // oldCapacity is 0 when no incremental rehash is in progress.
+  int oldCapacity {0};
+  int migratePos {0}; // The next old slot to move.
+  std::vector<unsigned char> oldCtrl;
+  std::unique_ptr<keySlot[]> oldKeys;
+  std::unique_ptr<void *[]> oldValues;
+
+  // Old slots moved by each operation during an incremental rehash.
+  static constexpr int MIGRATE_STEP = 2 * GROUP_WIDTH;
+
+  // True if the control byte belongs to an occupied slot.
+  static bool isFull(unsigned char c) { return ctrlGroup::isFull(c); }
+
+  // The 7-bit fingerprint stored in the control byte for a hash value.
+  static unsigned char fingerprint(uint64_t hashVal) { return ctrlGroup::fingerprint(hashVal); }
+
+  // Set the control byte of a slot, keeping the cloned tail in sync.
+  void setCtrl(int pos, unsigned char c);
+
+  // The hash function; returns the full (unreduced) hash value.
+  uint64_t hash(std::string_view key) const;
+
+  // The key a slot refers to.
+  std::string_view keyOf(const keySlot &k) const {
+    return std::string_view(k.data(arena.data()), k.length);
+  }
+
+  // Copy the key into the slot, or append it to the arena if long.
+  // Returns true on success, false if the arena cannot grow.
+  bool storeKey(std::string_view key, uint64_t hashVal, keySlot &k);
+
+  // Release the arena bytes, if any, of a removed key.
+  void releaseKey(const keySlot &k);
+
+  // Copy the live keys into a new arena, dropping removed ones.
+  void compactKeys();
+
+  // Probe the given slot arrays for the key, GROUP_WIDTH control bytes
+  // at a time. Return the position if found, -1 otherwise.
+  // If pFree is provided and the key is not found, write to that
+  // address the first free slot of the probe sequence.
+  static int probe(const unsigned char *ctrl, const keySlot *keys, const char *arena, unsigned int mask,
+                   std::string_view key, uint64_t hashVal, int *pFree = nullptr);
+
+  // Return the first empty slot of the probe sequence for a hash value.
+  int findEmpty(uint64_t hashVal);
+
+  // Search for an item with the specified key, without changing the
+  // table. Return the address of its pointer, in the current or (during
+  // an incremental rehash) the old arrays, or nullptr if not found.
+  void *const *lookup(std::string_view key) const;
+
+  // Search for an item with the specified key, to insert or remove it.
   // Return the position if found, -1 otherwise.
-  int findPos(const std::string &key);
+  // During an incremental rehash, some old slots are moved along, and
+  // an item found in the old arrays is moved first, so the position is
+  // always in the current arrays.
+  int findPos(std::string_view key, uint64_t hashVal, int *pFree = nullptr);
+  int findPos(std::string_view key);
+
+  // Put an item that is not in the current arrays into the first empty
+  // slot of its probe sequence. Nothing is hashed or compared.
+  // Returns its position.
+  int place(const keySlot &k, void *pv);
+
+  // Move the item in an old slot into the current arrays.
+  // Returns its new position.
+  int moveOldSlot(int oldPos);
 
-  // The rehash function; makes the hash table bigger.
+  // Move up to the specified number of old slots into the current
+  // arrays, releasing the old arrays once all have moved.
+  void migrate(int count);
+
+  // The rehash function; moves the items into arrays of the new
+  // capacity, which may be larger or smaller.
+  // Unless rehashing incrementally, every item is placed into the new
+  // arrays in one pass over the old ones.
   // Returns true on success, false if memory allocation fails.
-  bool rehash();
+  bool rehash(int newCapacity);
+
+  // The most items a capacity holds under the maximum load.
+  int loadLimit(int slots) const { return static_cast<int>(slots * policy.maxLoad); }
 
-  // Return a prime number at least as large as size.
-  // Uses a precomputed sequence of selected prime numbers.
-  static unsigned int getPrime(int size);
+  // Return a power of two at least as large as size and as the
+  // policy's minimum capacity.
+  int capacityFor(int size) const;
 };
 
 #endif //_HASH_H
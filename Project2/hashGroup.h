@@ -0,0 +1,46 @@
+#ifndef _HASH_GROUP_H
+#define _HASH_GROUP_H
+
+#include <cstdint>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//
+// The control bytes shared by hashTable and hashMap.
+//
+// Each slot of a table has one control byte: EMPTY, or for an occupied
+// slot a 7-bit fingerprint of its key's hash value. Probes load WIDTH
+// consecutive control bytes at once and match them against a
+// fingerprint, so keys are only compared when a fingerprint matches.
+//
+struct ctrlGroup {
+  static constexpr int WIDTH = 16;
+  static constexpr unsigned char EMPTY = 0x80;
+
+  // True if the control byte belongs to an occupied slot.
+  static bool isFull(unsigned char c) { return c < 0x80; }
+
+  // Use the top 7 bits of a hash value as the fingerprint.
+  static unsigned char fingerprint(uint64_t hashVal) {
+    return static_cast<unsigned char>(hashVal >> 57);
+  }
+
+  // Bit i of the result is set when group[i] equals c.
+  static unsigned int match(const unsigned char *group, unsigned char c) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(c))));
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < WIDTH; i++) {
+      if (group[i] == c) {
+        mask |= 1u << i;
+      }
+    }
+    return mask;
+#endif
+  }
+};
+
+#endif //_HASH_GROUP_H
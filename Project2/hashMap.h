@@ -0,0 +1,377 @@
+#ifndef _HASH_MAP_H
+#define _HASH_MAP_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+#include <cstdint>
+#include "hashFunctions.h"
+#include "hashGroup.h"
+
+//
+// The default hash for hashMap keys.
+// std::hash is the identity for integers, so its result is mixed with
+// the murmur3 finalizer before the table uses its low and high bits.
+//
+template <typename K>
+struct hashMapHash {
+  uint64_t operator()(const K &key) const {
+    uint64_t h = std::hash<K>()(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+};
+
+// Strings hash as views, so a std::string key can be looked up by a
+// std::string_view or a C string without building a std::string.
+template <>
+struct hashMapHash<std::string> {
+  uint64_t operator()(std::string_view key) const {
+    return hashWyhash(key.data(), key.size());
+  }
+};
+
+// Views hash as the strings they view.
+template <>
+struct hashMapHash<std::string_view> : hashMapHash<std::string> {};
+
+//
+// hashMap - an open-addressing hash table with keys and values stored
+// inline, in the same layout as hashTable: a control byte array probed
+// ctrlGroup::WIDTH bytes at a time, linear probing, and backward-shift
+// removal.
+//
+// Lookups are templates, so any type that Hash and Eq accept can be
+// used as the key of find, contains, tryEmplace, insertOrAssign and
+// remove (for std::string keys, std::string_view and C strings).
+//
+// The handles returned by find, tryEmplace and insertOrAssign give
+// direct access to a slot. A handle stays valid until the next insert
+// or remove on the map.
+//
+template <typename K, typename V, typename Hash = hashMapHash<K>, typename Eq = std::equal_to<>>
+class hashMap {
+
+  // Each occupied slot holds the key and its value, and the low bits
+  // of the key's hash value (capacities never exceed 2^30, so these
+  // give its home slot), so that removal and growth never hash a key
+  // again.
+  struct slot {
+    K key;
+    V value;
+    uint32_t hashLow;
+
+    template <typename Q, typename... Args>
+    slot(uint64_t hashVal, const Q &k, Args &&...args)
+        : key(k), value(std::forward<Args>(args)...), hashLow(static_cast<uint32_t>(hashVal)) {}
+  };
+
+ public:
+
+  // A reference to one slot of the map; false if nothing was found.
+  class handle {
+   public:
+    handle() = default;
+    explicit operator bool() const { return pSlot != nullptr; }
+    const K &key() const { return pSlot->key; }
+    V &value() const { return pSlot->value; }
+
+   private:
+    friend class hashMap;
+    explicit handle(slot *p) : pSlot(p) {}
+    slot *pSlot {nullptr};
+  };
+
+  // The constructor allocates room for at least size slots.
+  hashMap(int size = 0) { allocate(getCapacity(size)); }
+
+  hashMap(const hashMap &other) {
+    allocate(other.capacity);
+    try {
+      for (int i = 0; i < other.capacity; i++) {
+        if (ctrlGroup::isFull(other.ctrl[i])) {
+          new (&slots[i]) slot(other.slots[i]);
+          setCtrl(i, other.ctrl[i]);
+        }
+      }
+    } catch (...) {
+      release();
+      throw;
+    }
+    filled = other.filled;
+  }
+
+  // A moved-from map must be assigned to before it is used again.
+  hashMap(hashMap &&other) noexcept { swap(other); }
+
+  hashMap &operator=(hashMap other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~hashMap() { release(); }
+
+  // The number of items in the map.
+  int size() const { return filled; }
+
+  // Return a handle to the item with the specified key,
+  // or an empty handle if there is none.
+  template <typename Q>
+  handle find(const Q &key) {
+    int pos = probe(key, hasher(key));
+    return pos == -1 ? handle() : handle(&slots[pos]);
+  }
+
+  template <typename Q>
+  bool contains(const Q &key) {
+    return probe(key, hasher(key)) != -1;
+  }
+
+  // If the key is not in the map, insert it with a value constructed
+  // from args. Returns a handle to the item for the key, and true if
+  // it was inserted by this call.
+  template <typename Q, typename... Args>
+  std::pair<handle, bool> tryEmplace(const Q &key, Args &&...args) {
+    if (filled + 1 > capacity / 2) {
+      grow();
+    }
+    uint64_t hashVal = hasher(key);
+    int pos = -1;
+    int found = probe(key, hashVal, &pos);
+    if (found != -1) {
+      return {handle(&slots[found]), false};
+    }
+    return {emplaceAt(pos, hashVal, key, std::forward<Args>(args)...), true};
+  }
+
+  // Insert the key with the specified value, or overwrite the value
+  // if the key is already in the map. Returns a handle to the item,
+  // and true if it was inserted by this call.
+  template <typename Q, typename W>
+  std::pair<handle, bool> insertOrAssign(const Q &key, W &&value) {
+    if (filled + 1 > capacity / 2) {
+      grow();
+    }
+    uint64_t hashVal = hasher(key);
+    int pos = -1;
+    int found = probe(key, hashVal, &pos);
+    if (found != -1) {
+      slots[found].value = std::forward<W>(value);
+      return {handle(&slots[found]), false};
+    }
+    return {emplaceAt(pos, hashVal, key, std::forward<W>(value)), true};
+  }
+
+  // Delete the item with the specified key.
+  // Returns true on success, false if the key is not in the map.
+  template <typename Q>
+  bool remove(const Q &key) {
+    int pos = probe(key, hasher(key));
+    if (pos == -1) {
+      return false;
+    }
+    removeAt(pos);
+    return true;
+  }
+
+  // Delete the item a handle refers to.
+  void remove(handle h) { removeAt(static_cast<int>(h.pSlot - slots)); }
+
+  // Call f(key, value) for every item in the map.
+  template <typename F>
+  void forEach(F f) {
+    for (int i = 0; i < capacity; i++) {
+      if (ctrlGroup::isFull(ctrl[i])) {
+        f(static_cast<const K &>(slots[i].key), slots[i].value);
+      }
+    }
+  }
+
+  // Delete every item, keeping the current capacity.
+  void clear() {
+    for (int i = 0; i < capacity; i++) {
+      if (ctrlGroup::isFull(ctrl[i])) {
+        slots[i].~slot();
+      }
+    }
+    ctrl.assign(capacity + ctrlGroup::WIDTH - 1, ctrlGroup::EMPTY);
+    filled = 0;
+  }
+
+ private:
+
+  int capacity {0}; // The number of slots (a power of two).
+  int filled {0}; // The number of occupied slots.
+  std::vector<unsigned char> ctrl; // Control bytes, with the first WIDTH - 1 cloned at the end.
+  slot *slots {nullptr}; // Uninitialized storage; only occupied slots hold objects.
+  Hash hasher;
+  Eq equal;
+
+  void swap(hashMap &other) noexcept {
+    std::swap(capacity, other.capacity);
+    std::swap(filled, other.filled);
+    std::swap(ctrl, other.ctrl);
+    std::swap(slots, other.slots);
+    std::swap(hasher, other.hasher);
+    std::swap(equal, other.equal);
+  }
+
+  // Allocate empty control bytes and slot storage for newCapacity slots.
+  void allocate(int newCapacity) {
+    ctrl.assign(newCapacity + ctrlGroup::WIDTH - 1, ctrlGroup::EMPTY);
+    slots = std::allocator<slot>().allocate(newCapacity);
+    capacity = newCapacity;
+    filled = 0;
+  }
+
+  // Destroy every item and free the slot storage.
+  void release() {
+    if (slots) {
+      clear();
+      std::allocator<slot>().deallocate(slots, capacity);
+      slots = nullptr;
+    }
+  }
+
+  // Set a control byte and its clone past the end of the table.
+  void setCtrl(int pos, unsigned char c) { setCtrl(ctrl, capacity, pos, c); }
+
+  static void setCtrl(std::vector<unsigned char> &c, int slotCount, int pos, unsigned char b) {
+    c[pos] = b;
+    if (pos < ctrlGroup::WIDTH - 1) {
+      c[slotCount + pos] = b;
+    }
+  }
+
+  // Construct an item in the empty slot the probe for its key ended at.
+  template <typename Q, typename... Args>
+  handle emplaceAt(int pos, uint64_t hashVal, const Q &key, Args &&...args) {
+    new (&slots[pos]) slot(hashVal, key, std::forward<Args>(args)...);
+    setCtrl(pos, ctrlGroup::fingerprint(hashVal));
+    filled++;
+    return handle(&slots[pos]);
+  }
+
+  // Linear probing, one group of control bytes per iteration.
+  // Returns the position of the key, or -1 with the first empty slot
+  // of the probe sequence written to pFree.
+  template <typename Q>
+  int probe(const Q &key, uint64_t hashVal, int *pFree = nullptr) const {
+    unsigned int mask = capacity - 1;
+    unsigned char fp = ctrlGroup::fingerprint(hashVal);
+    int pos = hashVal & mask;
+    while (true) {
+      const unsigned char *group = &ctrl[pos];
+      unsigned int empty = ctrlGroup::match(group, ctrlGroup::EMPTY);
+      unsigned int candidates = ctrlGroup::match(group, fp);
+      if (empty) {
+        candidates &= (empty & -empty) - 1;
+      }
+      while (candidates) {
+        int i = (pos + __builtin_ctz(candidates)) & mask;
+        if (equal(slots[i].key, key)) {
+          return i;
+        }
+        candidates &= candidates - 1;
+      }
+      if (empty) {
+        if (pFree) {
+          *pFree = (pos + __builtin_ctz(empty)) & mask;
+        }
+        return -1;
+      }
+      pos = (pos + ctrlGroup::WIDTH) & mask;
+    }
+  }
+
+  // Return the first empty slot of the probe sequence for a hash value
+  // in the given control bytes.
+  static int findEmpty(const std::vector<unsigned char> &c, int slotCount, uint64_t hashVal) {
+    unsigned int mask = slotCount - 1;
+    int pos = hashVal & mask;
+    unsigned int empty;
+    while (!(empty = ctrlGroup::match(&c[pos], ctrlGroup::EMPTY))) {
+      pos = (pos + ctrlGroup::WIDTH) & mask;
+    }
+    return (pos + __builtin_ctz(empty)) & mask;
+  }
+
+  // Empty a slot, shifting later items of its cluster back into the hole.
+  void removeAt(int pos) {
+    unsigned int mask = capacity - 1;
+    int hole = pos;
+    slots[hole].~slot();
+    for (int next = (hole + 1) & mask; ctrlGroup::isFull(ctrl[next]); next = (next + 1) & mask) {
+      int home = slots[next].hashLow & mask;
+      // The item may move back unless its home lies after the hole
+      if (((next - home) & mask) >= ((next - hole) & mask)) {
+        setCtrl(hole, ctrl[next]);
+        new (&slots[hole]) slot(std::move(slots[next]));
+        slots[next].~slot();
+        hole = next;
+      }
+    }
+    setCtrl(hole, ctrlGroup::EMPTY);
+    filled--;
+  }
+
+  // Double the capacity, moving every item into the new slots.
+  // Keys are known to be distinct, so they are not compared, and their
+  // home slots and fingerprints are kept, so they are not hashed.
+  // The new arrays replace the old ones only once every item is in
+  // them, so if an allocation or copy throws, the map is left as it
+  // was. Items are copied unless their move cannot throw, as
+  // std::vector does; an item that can only be moved, by a move that
+  // throws, may be lost.
+  void grow() {
+    int newCapacity = capacity * 2;
+    std::vector<unsigned char> newCtrl(newCapacity + ctrlGroup::WIDTH - 1, ctrlGroup::EMPTY);
+    slot *newSlots = std::allocator<slot>().allocate(newCapacity);
+    try {
+      for (int i = 0; i < capacity; i++) {
+        if (ctrlGroup::isFull(ctrl[i])) {
+          int pos = findEmpty(newCtrl, newCapacity, slots[i].hashLow);
+          new (&newSlots[pos]) slot(std::move_if_noexcept(slots[i]));
+          setCtrl(newCtrl, newCapacity, pos, ctrl[i]);
+        }
+      }
+    } catch (...) {
+      for (int i = 0; i < newCapacity; i++) {
+        if (ctrlGroup::isFull(newCtrl[i])) {
+          newSlots[i].~slot();
+        }
+      }
+      std::allocator<slot>().deallocate(newSlots, newCapacity);
+      throw;
+    }
+    for (int i = 0; i < capacity; i++) {
+      if (ctrlGroup::isFull(ctrl[i])) {
+        slots[i].~slot();
+      }
+    }
+    std::allocator<slot>().deallocate(slots, capacity);
+    ctrl = std::move(newCtrl);
+    slots = newSlots;
+    capacity = newCapacity;
+  }
+
+  // Return a power of two at least as large as size, and at least one
+  // group wide.
+  static int getCapacity(int size) {
+    int newCapacity = ctrlGroup::WIDTH;
+    while (newCapacity < size && newCapacity < (1 << 30)) {
+      newCapacity <<= 1;
+    }
+    return newCapacity;
+  }
+};
+
+#endif //_HASH_MAP_H
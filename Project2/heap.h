@@ -3,30 +3,167 @@
 
 #include <vector>
 #include <string>
-#include "hash.h"
+#include <string_view>
+#include <functional>
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include "hashMap.h"
+
+//
+// heapBase - the node array and per-handle positions shared by every
+// heap, with keys of type Key ordered by Compare (smallest first with
+// the default std::less)
+//
+// The heap is d-ary with d = arity: 2, 4 or 8 (other values are
+// rounded to the nearest of these). Nodes are {key, handle} pairs,
+// and when a node's size divides 64 bytes the node array is laid out
+// so that the children of a node share one 64-byte cache line.
+//
+// Each node is named by a handle, a number from 0 to capacity - 1;
+// the heap classes below decide which handle a new node gets.
+//
+template <typename Key, typename Compare = std::less<Key>>
+class heapBase {
+  public:
+    // Return the number of nodes in the heap.
+    int getSize() const { return size; }
+
+    // Return the largest number of nodes the heap can hold.
+    int getCapacity() const { return capacity; }
+
+  protected:
+    heapBase(int capacity, int arity);
+
+    // Whether a node with the handle is in the heap
+    bool inHeap(int handle) const { return handle >= 0 && handle < capacity && positions[handle] != 0; }
+
+    // Add a node for an unused handle and restore the heap property
+    void placeNode(int handle, const Key &key, void *pv);
+
+    // Add a node for an unused handle at the end of the heap, leaving
+    // the heap property to a later heapifyFrom
+    void appendNode(int handle, const Key &key, void *pv);
+
+    // Restore the heap property when only the nodes from position
+    // first to the end may be out of place
+    void heapifyFrom(int first);
+
+    // Set the key of a node in the heap and restore the heap property
+    void changeKey(int handle, const Key &key);
+
+    // Set the key of a node in the heap, leaving the heap property to
+    // a later heapifyFrom(1)
+    void storeKey(int handle, const Key &key) { at(positions[handle]).key = key; }
+
+    // Whether restoring the whole heap at once is cheaper than count
+    // separate percolates
+    bool heapifyCheaper(size_t count) const;
+
+    // Return the handle of the node at a position, counting the root as 1
+    int handleAt(int pos) { return at(pos).handle; }
+
+    // Take every node out of the heap
+    void clearNodes();
+
+    // Move a node in the heap up to the root, whatever its key
+    void moveToRoot(int handle) { percolateUp(positions[handle], true); }
+
+    // Take the node at the root out of the heap, writing its key and
+    // data where supplied; returns its handle
+    int removeRoot(Key *pKey, void *ppData);
+
+  private:
+    class node { // An inner class within heap
+    public:
+      Key key; // The key of this node
+      int handle; // Indexes positions and pData
+    };
+    // The actual heap, with the root at index offset + 1; positions
+    // name nodes by index - offset, counting the root as 1
+    std::vector<node> data;
+    int offset;
+    int arityShift; // log2 of the arity
+
+    // Per-handle information, kept out of the nodes so that moving a
+    // node never allocates. A handle is in use while positions holds
+    // its node's index in data, and free while it holds 0.
+    std::vector<int> positions;
+    std::vector<void *> pData;
+
+    Compare less;
+    int size;
+    int capacity;
+
+    node &at(int pos) { return data[offset + pos]; }
+    void percolateUp(int posCur, bool toRoot = false);
+    void percolateDown(int posCur);
+};
+
+//
+// heap - a priority queue of nodes named by ids of type Id, with keys
+// of type Key ordered by Compare
+//
+// Ids are std::string by default. With an integral Id, ids are dense:
+// each is a number from 0 to capacity - 1 and is the node's handle, so
+// no id is ever hashed (see the specialization below).
+//
+template <typename Key = int, typename Id = std::string, typename Compare = std::less<Key>,
+          bool denseIds = std::is_integral_v<Id>>
+class heap : public heapBase<Key, Compare> {
+    static_assert(std::is_same_v<Id, std::string>, "heap ids are std::string or an integral type");
 
-class heap{
   public:
     //
     // heap - The constructor allocates space for the nodes of the heap
-    // and the mapping (hash table) based on the specified capacity
+    // based on the specified capacity, as a d-ary heap with d = arity
+    // (see heapBase)
     //
-    heap(int capacity);
+    heap(int capacity, int arity = 2);
 
     //
-    // insert - Inserts a new node into the binary heap
+    // heap - A copy has its own ids, so its mapping is rebuilt over
+    // them rather than copied; a moved heap keeps its strings where
+    // they are, so the mapping moves with them. A moved-from heap must
+    // be assigned to before it is used again.
+    //
+    heap(const heap &other);
+    heap &operator=(const heap &other);
+    heap(heap &&other) = default;
+    heap &operator=(heap &&other) = default;
+
+    //
+    // insert - Inserts a new node into the heap
     //
     // Inserts a node with the specified id string, key,
     // and optionally a pointer.  They key is used to
     // determine the final position of the new node.
     //
+    // If pHandle is supplied, write to that address the handle of the
+    // new node: a small integer that names the node until it leaves
+    // the heap, and that the handle versions of setKey and remove, and
+    // deleteMinHandle, take in place of the id.
+    //
     // Returns:
     //   0 on success
     //   1 if the heap is already filled to capacity
     //   2 if a node with the given id already exists (but the heap
     //     is not filled to capacity)
     //
-    int insert(const std::string &id, int key, void *pv = nullptr);
+    int insert(const std::string &id, const Key &key, void *pv = nullptr, int *pHandle = nullptr);
+
+    //
+    // insert - the same, for a node without an id
+    //
+    // The node can only be reached through its handle, and inserting
+    // or deleting it never hashes a string.
+    //
+    // Returns:
+    //   0 on success
+    //   1 if the heap is already filled to capacity
+    //
+    int insert(const Key &key, void *pv, int *pHandle);
 
     //
     // setKey - set the key of the specified node to the specified value
@@ -38,25 +175,55 @@ class heap{
     //   0 on success
     //   1 if a node with the given id does not exist
     //
-    int setKey(const std::string &id, int key);
+    int setKey(const std::string &id, const Key &key);
+
+    //
+    // setKey - the same, for the node with the specified handle
+    //
+    // The node is found without hashing its id.
+    //
+    // Returns:
+    //   0 on success
+    //   1 if no node in the heap has the given handle
+    //
+    int setKey(int handle, const Key &key);
 
     //
     // deleteMin - return the data associated with the smallest key
-    //             and delete that node from the binary heap
+    //             and delete that node from the heap
     //
     // If pId is supplied (i.e., it is not nullptr), write to that address
     // the id of the node being deleted. If pKey is supplied, write to
     // that address the key of the node being deleted. If ppData is
     // supplied, write to that address the associated void pointer.
     //
+    // The id is moved, not copied, into *pId, which gives its old
+    // buffer to the heap for reuse; neither allocates memory.
+    //
     // Returns:
     //   0 on success
     //   1 if the heap is empty
     //
-    int deleteMin(std::string *pId = nullptr, int *pKey = nullptr, void *ppData = nullptr);
+    int deleteMin(std::string *pId = nullptr, Key *pKey = nullptr, void *ppData = nullptr);
+
+    //
+    // deleteMinView - the same as deleteMin, writing to pId a view of
+    //                 the id of the node being deleted
+    //
+    // The view stays valid until the next insert.
+    //
+    int deleteMinView(std::string_view *pId, Key *pKey = nullptr, void *ppData = nullptr);
 
     //
-    // remove - delete the node with the specified id from the binary heap
+    // deleteMinHandle - the same as deleteMin, writing the handle of the
+    //                   node being deleted to pHandle instead of its id
+    //
+    // The handle is free for reuse once this returns.
+    //
+    int deleteMinHandle(int *pHandle, Key *pKey = nullptr, void *ppData = nullptr);
+
+    //
+    // remove - delete the node with the specified id from the heap
     //
     // If pKey is supplied, write to that address the key of the node
     // being deleted. If ppData is supplied, write to that address the
@@ -66,22 +233,791 @@ class heap{
     //   0 on success
     //   1 if a node with the given id does not exist
     //
-    int remove(const std::string &id, int *pKey = nullptr, void *ppData = nullptr);
+    int remove(const std::string &id, Key *pKey = nullptr, void *ppData = nullptr);
+
+    //
+    // remove - the same, for the node with the specified handle
+    //
+    // Returns:
+    //   0 on success
+    //   1 if no node in the heap has the given handle
+    //
+    int remove(int handle, Key *pKey = nullptr, void *ppData = nullptr);
+
+    //
+    // item - an id, key and pointer, for the batch functions below
+    //
+    struct item {
+      std::string id;
+      Key key;
+      void *pv = nullptr;
+    };
+
+    //
+    // insertBatch - insert every item of a range, then restore the heap
+    //               property in one pass
+    //
+    // The range holds item, or anything with id, key and pv members.
+    // The new nodes are added at the end of the heap, and only they
+    // and their ancestors are percolated down, children first, as in
+    // Floyd's heap construction: O(k + log^2 n) for k items, as the
+    // O(log n) ancestors above the new nodes' subtrees may each
+    // percolate down O(log n) levels.
+    //
+    // Returns:
+    //   0 if every item was inserted
+    //   otherwise what insert returns for the first item that was not
+    //   (that item is skipped, and the others are still inserted)
+    //
+    template <typename Range>
+    int insertBatch(const Range &items);
+
+    //
+    // buildFrom - empty the heap and insert every item of a range
+    //
+    // On an empty heap this is Floyd's O(n) heap construction.
+    // Returns what insertBatch returns.
+    //
+    template <typename Range>
+    int buildFrom(const Range &items);
+
+    //
+    // setKeyBatch - set the key of the node for every item of a range
+    //
+    // The range holds item, or anything with id and key members. When
+    // the batch is large next to the heap, every key is stored and the
+    // heap is rebuilt in one O(n) pass; otherwise each key is set in
+    // turn, as setKey would.
+    //
+    // Returns:
+    //   0 on success
+    //   1 if a node with some item's id does not exist (that item is
+    //     skipped)
+    //
+    template <typename Range>
+    int setKeyBatch(const Range &items);
+
+    //
+    // clear - delete every node from the heap
+    //
+    void clear();
+
+    //
+    // getHandle - return the handle of the node with the specified id,
+    //             or -1 if there is no such node
+    //
+    int getHandle(const std::string &id);
+
+    //
+    // getId - return the id of the node with the specified handle
+    //         (empty for a node inserted without one)
+    //
+    const std::string &getId(int handle) const;
 
   private:
-    class node { // An inner class within heap
-    public:
-      std::string id; // The id of this node
-      int key; // The key of this node
-      void *pData; // A pointer to the actual data
+    using base = heapBase<Key, Compare>;
+
+    std::vector<std::string> ids; // Sized, with mapping, on the first insert with an id
+    std::vector<bool> named; // Whether the node has an id in mapping
+    std::vector<int> freeHandles; // Handles given back, taken from the back
+    int nextHandle; // The lowest handle never yet taken
+
+    // maps ids to handles; the keys are views of the strings in ids,
+    // which never move, as ids is sized once
+    hashMap<std::string_view, int> mapping;
+
+    // Map the id of every named node to its handle, over this heap's ids
+    void rebuildMapping();
+
+    // The handle the next insert will take
+    int peekHandle() const { return freeHandles.empty() ? nextHandle : freeHandles.back(); }
+    int takeHandle();
+
+    // Free the handle of a node that has left the heap, dropping its
+    // id from the mapping; the id stays in ids until the handle is reused
+    void releaseHandle(int handle);
+};
+
+//
+// heap - the specialization for integral ids, which are their nodes'
+// handles
+//
+// The id API is a thin layer over heapBase: an id indexes the node
+// positions directly, with no hashing and no per-node strings.
+//
+template <typename Key, typename Id, typename Compare>
+class heap<Key, Id, Compare, true> : public heapBase<Key, Compare> {
+  public:
+    //
+    // heap - The constructor allocates space for the nodes of the heap,
+    // which may use the ids 0 to capacity - 1
+    //
+    heap(int capacity, int arity = 2) : heapBase<Key, Compare>(capacity, arity) {}
+
+    //
+    // insert - Inserts a new node with the specified id, key, and
+    // optionally a pointer
+    //
+    // Returns:
+    //   0 on success
+    //   2 if a node with the given id already exists
+    //   3 if the id is not from 0 to capacity - 1
+    //
+    int insert(Id id, const Key &key, void *pv = nullptr);
+
+    //
+    // setKey - set the key of the specified node to the specified value
+    //
+    // Returns:
+    //   0 on success
+    //   1 if a node with the given id does not exist
+    //
+    int setKey(Id id, const Key &key);
+
+    //
+    // deleteMin - delete the node with the smallest key, writing its
+    // id, key and associated pointer to the addresses supplied
+    //
+    // Returns:
+    //   0 on success
+    //   1 if the heap is empty
+    //
+    int deleteMin(Id *pId = nullptr, Key *pKey = nullptr, void *ppData = nullptr);
+
+    //
+    // remove - delete the node with the specified id, writing its key
+    // and associated pointer to the addresses supplied
+    //
+    // Returns:
+    //   0 on success
+    //   1 if a node with the given id does not exist
+    //
+    int remove(Id id, Key *pKey = nullptr, void *ppData = nullptr);
+
+    //
+    // contains - whether a node with the specified id is in the heap
+    //
+    bool contains(Id id) const { return this->inHeap(static_cast<int>(id)); }
+
+    //
+    // item - an id, key and pointer, for the batch functions below
+    //
+    struct item {
+      Id id;
+      Key key;
+      void *pv = nullptr;
     };
-    std::vector<node> data; // The actual binary heap
-    hashTable mapping; // maps ids to node pointers
-    void percolateUp(int posCur);
-    void percolateDown(int posCur);
-    int getPos(node *pn);
-    int size;
-    int capacity;
+
+    //
+    // insertBatch - insert every item of a range, then restore the heap
+    // property in one pass (see the string-id heap)
+    //
+    // Returns:
+    //   0 if every item was inserted
+    //   otherwise what insert returns for the first item that was not
+    //   (that item is skipped, and the others are still inserted)
+    //
+    template <typename Range>
+    int insertBatch(const Range &items);
+
+    //
+    // buildFrom - empty the heap and insert every item of a range, in
+    // O(n) on an empty heap; returns what insertBatch returns
+    //
+    template <typename Range>
+    int buildFrom(const Range &items);
+
+    //
+    // setKeyBatch - set the key of the node for every item of a range
+    // (see the string-id heap)
+    //
+    // Returns:
+    //   0 on success
+    //   1 if a node with some item's id does not exist (that item is
+    //     skipped)
+    //
+    template <typename Range>
+    int setKeyBatch(const Range &items);
+
+    //
+    // clear - delete every node from the heap
+    //
+    void clear() { this->clearNodes(); }
+
+  private:
+    // Check an id for insert; returns 0 if it can be inserted
+    int checkNewId(Id id) const;
 };
 
-#endif
\ No newline at end of file
+// Use provided code for heap constructor
+template <typename Key, typename Compare>
+heapBase<Key, Compare>::heapBase(int capacity, int arity) {
+    arityShift = arity >= 6 ? 3 : (arity >= 3 ? 2 : 1);
+    // Room for padding, so that the first child of the root (and with
+    // it every group of children) can start on a 64-byte boundary
+    data.resize(capacity + 1 + 64 / sizeof(node));
+    uintptr_t gap = (64 - reinterpret_cast<uintptr_t>(&data[2]) % 64) % 64;
+    offset = (64 % sizeof(node) == 0 && gap % sizeof(node) == 0) ? gap / sizeof(node) : 0;
+    // Every handle starts out free
+    positions.assign(capacity, 0);
+    pData.assign(capacity, nullptr);
+    // Initialize size and capacity of heap
+    this->capacity = capacity;
+    size = 0;
+}
+
+// Add a node at the end of the heap and percolate it up
+template <typename Key, typename Compare>
+void heapBase<Key, Compare>::placeNode(int handle, const Key &key, void *pv) {
+    appendNode(handle, key, pv);
+    percolateUp(size);
+}
+
+// Add a node at the end of the heap
+template <typename Key, typename Compare>
+void heapBase<Key, Compare>::appendNode(int handle, const Key &key, void *pv) {
+    pData[handle] = pv;
+    size++;
+    at(size).key = key;
+    at(size).handle = handle;
+    positions[handle] = size;
+}
+
+// Percolate down the nodes from first to the end and all of their
+// ancestors, each after all of its children, as Floyd's heap
+// construction does; a level's ancestors are a contiguous range, so
+// this visits O(k + log n) nodes for k appended ones, and percolating
+// them takes O(k + log^2 n) steps
+template <typename Key, typename Compare>
+void heapBase<Key, Compare>::heapifyFrom(int first) {
+    int lo = first, hi = size;
+    // Every node from done to the end has been percolated; leaves
+    // have nothing to percolate past
+    int done = size < 2 ? 1 : ((size - 2) >> arityShift) + 2;
+    while (lo <= hi) {
+        for (int index = std::min(hi, done - 1); index >= lo; index--) {
+            percolateDown(index);
+        }
+        done = std::min(done, lo);
+        if (lo == 1) {
+            break;
+        }
+        lo = ((lo - 2) >> arityShift) + 1;
+        hi = ((hi - 2) >> arityShift) + 1;
+    }
+}
+
+// A pass over the heap visits every node once, in order; a percolate
+// visits at most one node per level, and seldom all of them, but far
+// apart, so the pass is taken once the percolates could visit four
+// times as many nodes as the heap holds
+template <typename Key, typename Compare>
+bool heapBase<Key, Compare>::heapifyCheaper(size_t count) const {
+    size_t levels = 1;
+    for (int n = size; n > 1; n >>= arityShift) {
+        levels++;
+    }
+    return count * levels > 4 * static_cast<size_t>(size);
+}
+
+// Free the handle of every node
+template <typename Key, typename Compare>
+void heapBase<Key, Compare>::clearNodes() {
+    for (int pos = 1; pos <= size; pos++) {
+        positions[at(pos).handle] = 0;
+    }
+    size = 0;
+}
+
+// Set the key of a node
+template <typename Key, typename Compare>
+void heapBase<Key, Compare>::changeKey(int handle, const Key &key) {
+    int pos = positions[handle];
+    bool larger = less(at(pos).key, key);
+    at(pos).key = key;
+    // If the new key is larger, percolate down, else percolate up
+    if (larger) {
+        percolateDown(pos);
+    } else {
+        percolateUp(pos);
+    }
+}
+
+// Delete the root, writing its key and data depending on specified arugment
+template <typename Key, typename Compare>
+int heapBase<Key, Compare>::removeRoot(Key *pKey, void *ppData) {
+    int handle = at(1).handle;
+    if (pKey) {
+        *pKey = at(1).key;
+    }
+    // Provided code for filling in ppData
+    if (ppData) {
+        *(static_cast<void **>(ppData)) = pData[handle];
+    }
+    positions[handle] = 0;
+    // Replace root with last node in heap
+    at(1) = at(size--);
+    // Restore heap property by percolating down
+    if (size > 0) {
+        percolateDown(1);
+    }
+    return handle;
+}
+
+// Percolate up functionality
+// With toRoot set, the node moves all the way up whatever its key
+template <typename Key, typename Compare>
+void heapBase<Key, Compare>::percolateUp(int index, bool toRoot) {
+    node temp = at(index);
+    // Continue while node is not the root and key is less than its parent's key
+    for (int parent; index > 1; index = parent) {
+        parent = ((index - 2) >> arityShift) + 1;
+        if (!toRoot && !less(temp.key, at(parent).key)) {
+            break;
+        }
+        at(index) = at(parent);
+        positions[at(index).handle] = index;
+    }
+    // Place node in final position and update its position
+    at(index) = temp;
+    positions[temp.handle] = index;
+}
+
+// Percolate down functionality
+// The children of index are ((index - 1) << arityShift) + 2 onwards
+template <typename Key, typename Compare>
+void heapBase<Key, Compare>::percolateDown(int index) {
+    node temp = at(index);
+    int child;
+    // The last node with children; computed once, so that the index of
+    // a first child is never formed past the end of the heap
+    int lastParent = size < 2 ? 0 : ((size - 2) >> arityShift) + 1;
+    // Continue while index still has children
+    for (; index <= lastParent; index = child) {
+        child = ((index - 1) << arityShift) + 2;
+        int last = std::min(child + (1 << arityShift) - 1, size);
+        // Choose child with the smallest key, the first of any ties
+        for (int other = child + 1; other <= last; other++) {
+            if (less(at(other).key, at(child).key)) {
+                child = other;
+            }
+        }
+        // Swap keys if child's key is smaller than current node's key
+        if (less(at(child).key, temp.key)) {
+            at(index) = at(child);
+            positions[at(index).handle] = index;
+        } else {
+            break;
+        }
+    }
+    // Place node in final position and update its position
+    at(index) = temp;
+    positions[temp.handle] = index;
+}
+
+template <typename Key, typename Id, typename Compare, bool denseIds>
+heap<Key, Id, Compare, denseIds>::heap(int capacity, int arity) : base(capacity, arity) {
+    named.assign(capacity, false);
+    nextHandle = 0;
+}
+
+// Copy the nodes and ids, then map the copied ids
+template <typename Key, typename Id, typename Compare, bool denseIds>
+heap<Key, Id, Compare, denseIds>::heap(const heap &other)
+    : base(other), ids(other.ids), named(other.named), freeHandles(other.freeHandles), nextHandle(other.nextHandle) {
+    rebuildMapping();
+}
+
+template <typename Key, typename Id, typename Compare, bool denseIds>
+heap<Key, Id, Compare, denseIds> &heap<Key, Id, Compare, denseIds>::operator=(const heap &other) {
+    if (this != &other) {
+        *this = heap(other);
+    }
+    return *this;
+}
+
+template <typename Key, typename Id, typename Compare, bool denseIds>
+void heap<Key, Id, Compare, denseIds>::rebuildMapping() {
+    mapping = hashMap<std::string_view, int>(ids.empty() ? 0 : this->getCapacity() * 2);
+    for (int handle = 0; handle < static_cast<int>(ids.size()); handle++) {
+        if (named[handle]) {
+            mapping.tryEmplace(std::string_view(ids[handle]), handle);
+        }
+    }
+}
+
+// Take a free handle, reusing given back ones first
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::takeHandle() {
+    if (freeHandles.empty()) {
+        return nextHandle++;
+    }
+    int handle = freeHandles.back();
+    freeHandles.pop_back();
+    return handle;
+}
+
+// Give a handle back, dropping its id from the mapping
+template <typename Key, typename Id, typename Compare, bool denseIds>
+void heap<Key, Id, Compare, denseIds>::releaseHandle(int handle) {
+    if (named[handle]) {
+        mapping.remove(std::string_view(ids[handle]));
+        named[handle] = false;
+    }
+    freeHandles.push_back(handle);
+}
+
+// Insert a new node into the heap
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::insert(const std::string &id, const Key &key, void *pv, int *pHandle) {
+    // Return 1 if heap filled to capacity
+    if (this->getSize() == this->getCapacity()) {
+        return 1;
+    }
+    // The mapping and ids are only allocated once there is an id, so a
+    // heap used through handles alone does not pay for them
+    if (ids.empty()) {
+        mapping = hashMap<std::string_view, int>(this->getCapacity() * 2);
+        ids.resize(this->getCapacity());
+    }
+    // Copy id into the next handle's string, reusing its buffer, then
+    // add a view of it to the mapping; a single probe also tells
+    // whether it exists
+    int handle = peekHandle();
+    ids[handle] = id;
+    // Return 2 if given id exists
+    if (!mapping.tryEmplace(std::string_view(ids[handle]), handle).second) {
+        return 2;
+    }
+    takeHandle();
+    named[handle] = true;
+    if (pHandle) {
+        *pHandle = handle;
+    }
+    this->placeNode(handle, key, pv);
+    return 0;
+}
+
+// Insert a new node that has no id
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::insert(const Key &key, void *pv, int *pHandle) {
+    // Return 1 if heap filled to capacity
+    if (this->getSize() == this->getCapacity()) {
+        return 1;
+    }
+    int handle = takeHandle();
+    // Forget the id of the handle's last node
+    if (!ids.empty()) {
+        ids[handle].clear();
+    }
+    if (pHandle) {
+        *pHandle = handle;
+    }
+    this->placeNode(handle, key, pv);
+    return 0;
+}
+
+// Set the key of the specified node to the specified value
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::setKey(const std::string &id, const Key &key) {
+    // Return 1 if node does not exist
+    auto found = mapping.find(id);
+    if (!found) {
+        return 1;
+    }
+    this->changeKey(found.value(), key);
+    return 0;
+}
+
+// Set the key of the node with the specified handle
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::setKey(int handle, const Key &key) {
+    // Return 1 if no node has the handle
+    if (!this->inHeap(handle)) {
+        return 1;
+    }
+    this->changeKey(handle, key);
+    return 0;
+}
+
+// Return data with the smallest key and delete it from the heap
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::deleteMin(std::string *pId, Key *pKey, void *ppData) {
+    // Return 1 if heap is empty
+    if (this->getSize() == 0) {
+        return 1;
+    }
+    int handle = this->removeRoot(pKey, ppData);
+    releaseHandle(handle);
+    // Write data depending on specified arugment
+    // The strings are swapped rather than move assigned, so the
+    // caller's old buffer is kept for the handle's next id
+    if (pId && ids.empty()) {
+        pId->clear();
+    } else if (pId) {
+        pId->swap(ids[handle]);
+        ids[handle].clear();
+    }
+    return 0;
+}
+
+// The same, with a view of the id
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::deleteMinView(std::string_view *pId, Key *pKey, void *ppData) {
+    // Return 1 if heap is empty
+    if (this->getSize() == 0) {
+        return 1;
+    }
+    int handle = this->removeRoot(pKey, ppData);
+    releaseHandle(handle);
+    if (pId) {
+        *pId = ids.empty() ? std::string_view() : std::string_view(ids[handle]);
+    }
+    return 0;
+}
+
+// Return the handle of the node with the smallest key and delete it
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::deleteMinHandle(int *pHandle, Key *pKey, void *ppData) {
+    // Return 1 if heap is empty
+    if (this->getSize() == 0) {
+        return 1;
+    }
+    int handle = this->removeRoot(pKey, ppData);
+    releaseHandle(handle);
+    if (pHandle) {
+        *pHandle = handle;
+    }
+    return 0;
+}
+
+// Delete node with the specified id from the heap
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::remove(const std::string &id, Key *pKey, void *ppData) {
+    // Return 1 if node with id does not exist
+    auto found = mapping.find(id);
+    if (!found) {
+        return 1;
+    }
+    return remove(found.value(), pKey, ppData);
+}
+
+// Delete the node with the specified handle from the heap
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::remove(int handle, Key *pKey, void *ppData) {
+    // Return 1 if no node has the handle
+    if (!this->inHeap(handle)) {
+        return 1;
+    }
+    // Move the node up to the root and delete it from there
+    this->moveToRoot(handle);
+    releaseHandle(this->removeRoot(pKey, ppData));
+    return 0;
+}
+
+// Insert the items at the end of the heap, then fix the heap in one pass
+template <typename Key, typename Id, typename Compare, bool denseIds>
+template <typename Range>
+int heap<Key, Id, Compare, denseIds>::insertBatch(const Range &items) {
+    int first = this->getSize() + 1;
+    int result = 0;
+    for (const auto &it : items) {
+        int retVal;
+        // Return 1 if heap filled to capacity
+        if (this->getSize() == this->getCapacity()) {
+            retVal = 1;
+        } else {
+            if (ids.empty()) {
+                mapping = hashMap<std::string_view, int>(this->getCapacity() * 2);
+                ids.resize(this->getCapacity());
+            }
+            int handle = peekHandle();
+            ids[handle] = it.id;
+            retVal = 2;
+            if (mapping.tryEmplace(std::string_view(ids[handle]), handle).second) {
+                takeHandle();
+                named[handle] = true;
+                this->appendNode(handle, it.key, it.pv);
+                retVal = 0;
+            }
+        }
+        if (result == 0) {
+            result = retVal;
+        }
+    }
+    this->heapifyFrom(first);
+    return result;
+}
+
+// Empty the heap and build it from the items
+template <typename Key, typename Id, typename Compare, bool denseIds>
+template <typename Range>
+int heap<Key, Id, Compare, denseIds>::buildFrom(const Range &items) {
+    clear();
+    return insertBatch(items);
+}
+
+// Set many keys, rebuilding the heap once if that is cheaper
+template <typename Key, typename Id, typename Compare, bool denseIds>
+template <typename Range>
+int heap<Key, Id, Compare, denseIds>::setKeyBatch(const Range &items) {
+    int result = 0;
+    if (!this->heapifyCheaper(std::size(items))) {
+        for (const auto &it : items) {
+            result |= setKey(it.id, it.key);
+        }
+        return result;
+    }
+    for (const auto &it : items) {
+        auto found = mapping.find(it.id);
+        if (found) {
+            this->storeKey(found.value(), it.key);
+        } else {
+            result = 1;
+        }
+    }
+    this->heapifyFrom(1);
+    return result;
+}
+
+// Delete every node, giving back their handles
+template <typename Key, typename Id, typename Compare, bool denseIds>
+void heap<Key, Id, Compare, denseIds>::clear() {
+    for (int pos = 1; pos <= this->getSize(); pos++) {
+        releaseHandle(this->handleAt(pos));
+    }
+    this->clearNodes();
+}
+
+// Return the handle of the node with the specified id
+template <typename Key, typename Id, typename Compare, bool denseIds>
+int heap<Key, Id, Compare, denseIds>::getHandle(const std::string &id) {
+    auto found = mapping.find(id);
+    return found ? found.value() : -1;
+}
+
+// Return the id of the node with the specified handle
+template <typename Key, typename Id, typename Compare, bool denseIds>
+const std::string &heap<Key, Id, Compare, denseIds>::getId(int handle) const {
+    static const std::string none;
+    return named[handle] ? ids[handle] : none;
+}
+
+// Return 3 if the id cannot be a handle, 2 if it is in use
+template <typename Key, typename Id, typename Compare>
+int heap<Key, Id, Compare, true>::checkNewId(Id id) const {
+    if constexpr (std::is_signed_v<Id>) {
+        if (id < 0) {
+            return 3;
+        }
+    }
+    if (static_cast<uint64_t>(id) >= static_cast<uint64_t>(this->getCapacity())) {
+        return 3;
+    }
+    if (this->inHeap(static_cast<int>(id))) {
+        return 2;
+    }
+    return 0;
+}
+
+// Insert a node whose handle is its id
+template <typename Key, typename Id, typename Compare>
+int heap<Key, Id, Compare, true>::insert(Id id, const Key &key, void *pv) {
+    int retVal = checkNewId(id);
+    if (retVal == 0) {
+        this->placeNode(static_cast<int>(id), key, pv);
+    }
+    return retVal;
+}
+
+// Insert the items at the end of the heap, then fix the heap in one pass
+template <typename Key, typename Id, typename Compare>
+template <typename Range>
+int heap<Key, Id, Compare, true>::insertBatch(const Range &items) {
+    int first = this->getSize() + 1;
+    int result = 0;
+    for (const auto &it : items) {
+        int retVal = checkNewId(it.id);
+        if (retVal == 0) {
+            this->appendNode(static_cast<int>(it.id), it.key, it.pv);
+        } else if (result == 0) {
+            result = retVal;
+        }
+    }
+    this->heapifyFrom(first);
+    return result;
+}
+
+// Empty the heap and build it from the items
+template <typename Key, typename Id, typename Compare>
+template <typename Range>
+int heap<Key, Id, Compare, true>::buildFrom(const Range &items) {
+    clear();
+    return insertBatch(items);
+}
+
+// Set many keys, rebuilding the heap once if that is cheaper
+template <typename Key, typename Id, typename Compare>
+template <typename Range>
+int heap<Key, Id, Compare, true>::setKeyBatch(const Range &items) {
+    int result = 0;
+    if (!this->heapifyCheaper(std::size(items))) {
+        for (const auto &it : items) {
+            result |= setKey(it.id, it.key);
+        }
+        return result;
+    }
+    for (const auto &it : items) {
+        if (contains(it.id)) {
+            this->storeKey(static_cast<int>(it.id), it.key);
+        } else {
+            result = 1;
+        }
+    }
+    this->heapifyFrom(1);
+    return result;
+}
+
+// Set the key of the node with the specified id
+template <typename Key, typename Id, typename Compare>
+int heap<Key, Id, Compare, true>::setKey(Id id, const Key &key) {
+    // Return 1 if node does not exist
+    if (!contains(id)) {
+        return 1;
+    }
+    this->changeKey(static_cast<int>(id), key);
+    return 0;
+}
+
+// Return data with the smallest key and delete it from the heap
+template <typename Key, typename Id, typename Compare>
+int heap<Key, Id, Compare, true>::deleteMin(Id *pId, Key *pKey, void *ppData) {
+    // Return 1 if heap is empty
+    if (this->getSize() == 0) {
+        return 1;
+    }
+    int handle = this->removeRoot(pKey, ppData);
+    if (pId) {
+        *pId = static_cast<Id>(handle);
+    }
+    return 0;
+}
+
+// Delete the node with the specified id from the heap
+template <typename Key, typename Id, typename Compare>
+int heap<Key, Id, Compare, true>::remove(Id id, Key *pKey, void *ppData) {
+    // Return 1 if node with id does not exist
+    if (!contains(id)) {
+        return 1;
+    }
+    // Move the node up to the root and delete it from there
+    this->moveToRoot(static_cast<int>(id));
+    this->removeRoot(pKey, ppData);
+    return 0;
+}
+
+// The string-id heap with int keys is built once, in heap.cpp
+extern template class heapBase<int>;
+extern template class heap<>;
+
+#endif
@@ -1,40 +1,45 @@
 #include "graph.h"
+#include "outputBuffer.h"
+#include "inputReader.h"
+
+#include <charconv>
 
 // Load the graph from an input file, creating vertices and edges based on file content
 void graph::loadGraph(std::string infile) {
-    std::string txtLine, startingV, endingV;
-    int cost;
-    vertex *pv;
-    std::ifstream input(infile);
-    
-    // Read each line in the file to extract edge information
-    while (std::getline(input, txtLine)) {
-        std::stringstream ss(txtLine);
-        // Extract starting vertex, ending vertex, and cost for each edge
-        ss >> startingV >> endingV >> cost;
-        edge e = edge(startingV, endingV, cost);
-
-        // Check and add starting vertex if it hasn't been added yet
-        if (!vertices.contains(startingV)) {
-            pv = new vertex(startingV);
-            vertices.insert(startingV, pv);
-            visited.push_back(startingV);
+    std::string_view fields[3];
+    vertex *pv, *pend;
+    inputReader input;
+    input.open(infile);
+
+    // Read the starting vertex, ending vertex, and cost of each edge
+    // The fields are views into the mapped file; only the vertex ids are copied
+    while (input.getFields(fields, 3)) {
+        std::string_view startingV = fields[0], endingV = fields[1];
+        int cost = 0;
+        std::from_chars(fields[2].data(), fields[2].data() + fields[2].size(), cost);
+
+        // Find the starting vertex, adding it if it hasn't been added yet
+        auto found = vertices.tryEmplace(startingV, nullptr);
+        if (found.second) {
+            found.first.value() = new vertex(std::string(startingV), size);
+            byIndex.push_back(found.first.value());
+            visited.push_back(found.first.value()->id);
             size++;
-        } else { 
-            // Retrieve existing vertex
-            pv = static_cast<vertex *>(vertices.getPointer(startingV)); 
         }
-
-        // Add the edge to the vertex's adjacency list
-        pv->adj.push_back(e);
-
-        // Check and add ending vertex if it hasn't been added yet
-        if (!vertices.contains(endingV)) {
-            pv = new vertex(endingV);
-            vertices.insert(endingV, pv);
-            visited.push_back(endingV);
+        pv = found.first.value();
+
+        // Add ending vertex if it hasn't been added yet
+        found = vertices.tryEmplace(endingV, nullptr);
+        if (found.second) {
+            found.first.value() = new vertex(std::string(endingV), size);
+            byIndex.push_back(found.first.value());
+            visited.push_back(found.first.value()->id);
             size++;
         }
+        pend = found.first.value();
+
+        // Add the edge to the starting vertex's adjacency list
+        pv->adj.push_back(edge(pend, cost));
     }
 }
 
@@ -46,38 +51,44 @@ bool graph::validVertex(std::string v) {
 // Implementation of Dijkstra's algorithm
 void graph::dijkstra(std::string start) {
     vertex *pv, *pend;
-    pv = static_cast<vertex *>(vertices.getPointer(start));
+    pv = vertices.find(start).value();
     // Distance to start vertex is zero
     pv->dv = 0;
     pv->known = true;
 
-    heap graphHeap = heap(size);
+    // Vertices are numbered densely, so their numbers are the heap ids
+    // and no vertex id is hashed by the heap; distances are 64-bit, so
+    // adding an edge cost cannot overflow
+    heap<int64_t, int> graphHeap(size);
 
-    // Initialize all vertices in the heap with their initial distances
-    for (const auto &vId : visited) {
-        vertex *v = static_cast<vertex *>(vertices.getPointer(vId));
-        int initialDist = (vId == start) ? 0 : INT_MAX;
-        graphHeap.insert(vId, initialDist);
-        v->dv = initialDist;
+    // Initialize all vertices with their initial distances, then build
+    // the heap from them in one O(n) pass
+    std::vector<heap<int64_t, int>::item> items(size);
+    for (vertex *v : byIndex) {
+        v->dv = (v == pv) ? 0 : NO_PATH;
         v->pred = nullptr;
+        items[v->index] = {v->index, v->dv, v};
     }
+    graphHeap.buildFrom(items);
 
-    std::string id;
-    int dv;
+    int64_t dv;
 
     // Process each vertex using the heap
-    while (!graphHeap.deleteMin(&id, &dv)) {
-        pv = static_cast<vertex *>(vertices.getPointer(id));
+    while (!graphHeap.deleteMin(nullptr, &dv, &pv)) {
+        // The vertices left are not reachable from the start vertex
+        if (dv == NO_PATH) {
+            break;
+        }
         pv->known = true;
 
         // Update distances for adjacent vertices
         for (auto &edge : pv->adj) {
-            pend = static_cast<vertex *>(vertices.getPointer(edge.endingV));
-            int newDist = pv->dv + edge.cost;
+            pend = edge.endingV;
+            int64_t newDist = pv->dv + edge.cost;
             if (newDist < pend->dv) {
                 pend->dv = newDist;
                 pend->pred = pv;
-                graphHeap.setKey(edge.endingV, newDist);
+                graphHeap.setKey(pend->index, newDist);
             }
         }
     }
@@ -86,7 +97,7 @@ void graph::dijkstra(std::string start) {
 // Build paths for each vertex from the start vertex
 void graph::buildPaths() {
     for (const auto &vertexId : visited) {
-        vertex *v = static_cast<vertex *>(vertices.getPointer(vertexId));
+        vertex *v = vertices.find(vertexId).value();
         std::list<std::string> path;
 
         // Construct the path from start to the current vertex
@@ -104,18 +115,20 @@ void graph::buildPaths() {
 void graph::outputPaths(std::string outputFile) {
     buildPaths(); // Ensure paths are built before outputting
 
-    std::ofstream output(outputFile);
+    // Lines are gathered in a large buffer and written out a buffer at a time
+    outputBuffer output;
+    output.open(outputFile);
     // Write each vertex's shortest path information to the file
     for (const auto &vertexId : visited) {
-        vertex *pv = static_cast<vertex *>(vertices.getPointer(vertexId));
+        vertex *pv = vertices.find(vertexId).value();
         output << pv->id << ": ";
-        if (pv->dv == INT_MAX) {
+        if (pv->dv == NO_PATH) {
             // Indicate no path if distance is infinity
             output << "NO PATH";
         } else {
             // Output distance and path
             output << pv->dv << " [" << pv->path << "]";
         }
-        output << std::endl;
+        output << '\n';
     }
 }
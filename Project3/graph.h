@@ -1,10 +1,13 @@
 #include <fstream>
 #include <sstream>
 #include <list>
+#include <vector>
 #include <iterator>
 #include "heap.h"
+#include "hashMap.h"
 #include <climits>
 #include <numeric>
+#include <cstdint>
 
 class graph {
 public:
@@ -19,19 +22,25 @@ public:
     // Generates the output file with shortest paths and distances from the start vertex
     void outputPaths(std::string outfile);
 
+    // The distance of a vertex not reached from the start vertex
+    static constexpr int64_t NO_PATH = INT64_MAX;
+
 private:
-    // Hash table for storing vertices
-    hashTable vertices;
+    struct vertex;
+
+    // Hash table for storing vertices by id
+    hashMap<std::string, vertex *> vertices;
     // Keeps track of the order in which vertices are processed
     std::list<std::string> visited;
     // Size of the graph
     int size = 0;
-    // Graph edge struct (starting/ending vertices + cost)
+    // Graph edge struct (ending vertex + cost); the edge is kept in its
+    // starting vertex's adjacency list, and the ending vertex is resolved
+    // once at load time so dijkstra never looks it up by id
     struct edge {
-        std::string startingV;
-        std::string endingV;
+        vertex *endingV;
         int cost;
-        edge(std::string startVertex, std::string endVertex, int w) : startingV(startVertex), endingV(endVertex), cost(w) {}
+        edge(vertex *endVertex, int w) : endingV(endVertex), cost(w) {}
     };
 
     // Represents a graph vertex with its ID, adjacency list, and shortest path info
@@ -39,11 +48,15 @@ private:
         std::string id;
         std::list<edge> adj;
         bool known = false;
-        int dv = INT_MAX;
+        int64_t dv = NO_PATH;
         vertex *pred = nullptr;
+        int index; // The order the vertex was first seen in, and its id in the dijkstra heap
         std::string path = "";
 
         // Constructor for creating a vertex with a given ID
-        vertex(std::string s) : id(s) {}
+        vertex(std::string s, int i) : id(s), index(i) {}
     }; 
+
+    // The vertices by index, in the order they were first seen
+    std::vector<vertex *> byIndex;
 };
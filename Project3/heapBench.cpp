@@ -0,0 +1,307 @@
+//
+// Benchmark for the heap layouts.
+//
+// For 10 thousand, 1 million and 100 million nodes (or the sizes given),
+// and for arities 2 (the binary layout), 4 and 8, fills a heap through
+// handles with random keys, then times up to a million setKey calls on
+// random nodes with random keys, followed by up to a million deleteMin
+// calls. Nodes have no ids, so only the node array and the per-handle
+// positions are touched. Throughput is in millions of operations per
+// second.
+//
+// Then, for up to a million nodes of each size, the same with 32-byte
+// string ids (too long for std::string to keep in place), counting the
+// memory allocations of each operation: insert, setKey by id, and
+// deleteMin writing the id to a std::string and to a std::string_view.
+// The heap is filled and drained once first, so the counts are of a
+// heap in steady use.
+//
+// Last, for up to a million nodes, the same with dense integer ids and
+// keys of type int, int64_t, double and (int64_t distance, int hops)
+// pairs, to show the cost of wider keys and nodes.
+//
+// Finally, for up to 10 million nodes, building a heap<int64_t, int>
+// as dijkstra starts one (one key of 0, the rest INT64_MAX), with
+// random keys, and with descending keys (the worst case for separate
+// inserts, as each goes to the root), by separate inserts and by
+// buildFrom; and setting a quarter of the keys at random by separate
+// setKey calls and by one setKeyBatch. Times are in nanoseconds per
+// node.
+//
+// Usage: heapBench.exe [size ...]
+//
+
+#include "heap.h"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <utility>
+#include <new>
+
+// Every allocation, counted so each phase can report its own
+static long allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    void *p = malloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+// Seconds since start
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Time one arity at one size, printing a line of results
+static void runLayout(int n, int arity) {
+    const int MAX_OPS = 1000000;
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> randomKey(0, 1000000000);
+    int ops = std::min(n, MAX_OPS);
+
+    heap h(n, arity);
+    std::vector<int> handles(n);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        h.insert(randomKey(rng), nullptr, &handles[i]);
+    }
+    double insertSecs = since(start);
+
+    // Draw the operands first, so the timings are of the heap alone
+    std::vector<std::pair<int, int>> updates(ops);
+    for (auto &update : updates) {
+        update = {handles[rng() % n], randomKey(rng)};
+    }
+    start = std::chrono::steady_clock::now();
+    for (const auto &update : updates) {
+        h.setKey(update.first, update.second);
+    }
+    double setKeySecs = since(start);
+
+    long checksum = 0;
+    int key;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ops; i++) {
+        h.deleteMinHandle(nullptr, &key);
+        checksum += key;
+    }
+    double deleteMinSecs = since(start);
+
+    std::cout << n << ", " << arity << ", " << n / insertSecs / 1e6 << ", " << ops / setKeySecs / 1e6 << ", "
+              << ops / deleteMinSecs / 1e6 << ", " << checksum << std::endl;
+}
+
+// Print the rate and allocations per operation of a phase
+static void report(int n, const char *operation, int ops, double secs, long allocated) {
+    std::cout << n << ", " << operation << ", " << ops / secs / 1e6 << ", "
+              << static_cast<double>(allocated) / ops << std::endl;
+}
+
+// Time the operations by id at one size, with arity 2
+static void runIds(int n) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> randomKey(0, 1000000000);
+    std::vector<std::string> ids(n);
+    for (int i = 0; i < n; i++) {
+        ids[i] = "id-" + std::to_string(i);
+        ids[i].resize(32, '.');
+    }
+    std::vector<int> keys(n);
+    std::vector<std::pair<int, int>> updates(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = randomKey(rng);
+        updates[i] = {static_cast<int>(rng() % n), randomKey(rng)};
+    }
+
+    heap h(n);
+    std::string id;
+    std::string_view view;
+    for (int round = 0; round < 2; round++) {
+        long before = allocations;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            h.insert(ids[i], keys[i]);
+        }
+        if (round == 0) {
+            // Warm up: drain the heap again
+            while (!h.deleteMin(&id)) {
+            }
+            continue;
+        }
+        report(n, "insert", n, since(start), allocations - before);
+
+        before = allocations;
+        start = std::chrono::steady_clock::now();
+        for (const auto &update : updates) {
+            h.setKey(ids[update.first], update.second);
+        }
+        report(n, "setKey", n, since(start), allocations - before);
+
+        before = allocations;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n / 2; i++) {
+            h.deleteMin(&id);
+        }
+        report(n, "deleteMin to string", n / 2, since(start), allocations - before);
+
+        before = allocations;
+        start = std::chrono::steady_clock::now();
+        for (int i = n / 2; i < n; i++) {
+            h.deleteMinView(&view);
+        }
+        report(n, "deleteMin to view", n - n / 2, since(start), allocations - before);
+    }
+}
+
+// Make a random key of each type
+template <typename Key>
+static Key makeKey(std::mt19937 &rng) {
+    return static_cast<Key>(rng() % 1000000000);
+}
+
+template <>
+std::pair<int64_t, int> makeKey(std::mt19937 &rng) {
+    return {rng() % 1000, static_cast<int>(rng() % 100)};
+}
+
+// Time one key type at one size and arity, with integer ids
+template <typename Key>
+static void runKeyType(int n, int arity, const char *name) {
+    std::mt19937 rng(12345);
+    std::vector<Key> keys(n);
+    std::vector<std::pair<int, Key>> updates(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = makeKey<Key>(rng);
+        updates[i] = {static_cast<int>(rng() % n), makeKey<Key>(rng)};
+    }
+
+    heap<Key, int> h(n, arity);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        h.insert(i, keys[i]);
+    }
+    double insertSecs = since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (const auto &update : updates) {
+        h.setKey(update.first, update.second);
+    }
+    double setKeySecs = since(start);
+
+    int id;
+    long checksum = 0;
+    start = std::chrono::steady_clock::now();
+    while (!h.deleteMin(&id)) {
+        checksum += id;
+    }
+    double deleteMinSecs = since(start);
+
+    std::cout << n << ", " << name << ", " << arity << ", " << n / insertSecs / 1e6 << ", " << n / setKeySecs / 1e6
+              << ", " << n / deleteMinSecs / 1e6 << ", " << checksum << std::endl;
+}
+
+// Time building a heap from the items, one insert at a time and with
+// buildFrom, then setting the update keys one at a time and as a batch
+// Keys are as dijkstra sets them (pattern 0), random (1) or descending (2)
+static void runBuild(int n, int pattern) {
+    using itemList = std::vector<heap<int64_t, int>::item>;
+    std::mt19937 rng(12345);
+    itemList items(n), updates(n / 4);
+    for (int i = 0; i < n; i++) {
+        int64_t key = n - i;
+        if (pattern == 0) {
+            key = i == n / 2 ? 0 : INT64_MAX;
+        } else if (pattern == 1) {
+            key = rng() % 1000000000;
+        }
+        items[i] = {i, key};
+    }
+    for (auto &update : updates) {
+        update = {static_cast<int>(rng() % n), static_cast<int64_t>(rng() % 1000000000)};
+    }
+    const char *keys = pattern == 0 ? "dijkstra keys" : (pattern == 1 ? "random keys" : "descending keys");
+
+    heap<int64_t, int> single(n), batch(n);
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &it : items) {
+        single.insert(it.id, it.key);
+    }
+    double insertSecs = since(start);
+    start = std::chrono::steady_clock::now();
+    batch.buildFrom(items);
+    double buildSecs = since(start);
+    std::cout << n << ", " << keys << ", inserts " << 1e9 * insertSecs / n << ", buildFrom "
+              << 1e9 * buildSecs / n << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (const auto &update : updates) {
+        single.setKey(update.id, update.key);
+    }
+    double setKeySecs = since(start);
+    start = std::chrono::steady_clock::now();
+    batch.setKeyBatch(updates);
+    double batchSecs = since(start);
+    std::cout << n << ", " << keys << ", setKey " << 1e9 * setKeySecs / updates.size() << ", setKeyBatch "
+              << 1e9 * batchSecs / updates.size() << std::endl;
+
+    // Both heaps must give up the same keys in the same order
+    int64_t key1, key2;
+    while (!single.deleteMin(nullptr, &key1)) {
+        if (batch.deleteMin(nullptr, &key2) || key1 != key2) {
+            std::cout << "  error: the heaps differ" << std::endl;
+            break;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(atoi(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {10000, 1000000, 100000000};
+    }
+    std::cout << "nodes, arity, insert Mops/s, setKey Mops/s, deleteMin Mops/s, checksum" << std::endl;
+    for (int n : sizes) {
+        for (int arity : {2, 4, 8}) {
+            runLayout(n, arity);
+        }
+    }
+    std::cout << "nodes, operation with ids, Mops/s, allocations/op" << std::endl;
+    for (int n : sizes) {
+        runIds(std::min(n, 1000000));
+    }
+    std::cout << "nodes, key type, arity, insert Mops/s, setKey Mops/s, deleteMin Mops/s, checksum" << std::endl;
+    for (int n : sizes) {
+        for (int arity : {2, 4}) {
+            runKeyType<int>(std::min(n, 1000000), arity, "int");
+            runKeyType<int64_t>(std::min(n, 1000000), arity, "int64_t");
+            runKeyType<double>(std::min(n, 1000000), arity, "double");
+            runKeyType<std::pair<int64_t, int>>(std::min(n, 1000000), arity, "(int64_t, int)");
+        }
+    }
+    std::cout << "nodes, keys, ns/node one at a time, ns/node in one batch" << std::endl;
+    for (int n : sizes) {
+        for (int pattern : {0, 1, 2}) {
+            runBuild(std::min(n, 10000000), pattern);
+        }
+    }
+    return 0;
+}
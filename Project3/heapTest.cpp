@@ -0,0 +1,263 @@
+//
+// Randomized test for the string-id heap.
+//
+// For arities 2, 4 and 8, runs random inserts, setKey, remove and
+// deleteMin calls, and batches of inserts (insertBatch and buildFrom)
+// and of setKey calls (setKeyBatch), on a heap<int> and on a
+// reference: a std::multimap from keys to ids, with each id's entry
+// found through a std::map. A batch is run on the reference one item
+// at a time, and has to match it. Batches range from one item to more
+// than the heap holds, so setKeyBatch both sets keys in turn and
+// rebuilds the heap.
+// Every return value, and every id and key a deleteMin or remove
+// writes back, is checked against the reference. A deleteMin may take
+// any node of the smallest key, so it only has to return one of them.
+//
+// Now and then the heap is copied, by the copy constructor and by
+// assignment over a heap already in use, and the copy is run against a
+// copy of the reference; then the original is drained against its own
+// reference, to check that the two heaps share nothing.
+//
+// Usage: heapTest.exe [rounds]
+// Prints "ok" and exits with 0, or reports the first mismatch and
+// exits with 1.
+//
+
+#include "heap.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cstdlib>
+
+static constexpr int CAPACITY = 500;
+static constexpr int NUM_IDS = 800; // More than fit, so inserts may fail
+static constexpr int KEY_RANGE = 100; // Small, so keys are often tied
+
+// The nodes a heap should hold
+class reference {
+  public:
+    reference() = default;
+
+    // The copy needs iterators into its own multimap
+    reference(const reference &other) {
+        for (const auto &[key, id] : other.byKey) {
+            insert(id, key);
+        }
+    }
+    reference &operator=(const reference &) = delete;
+
+    int size() const { return static_cast<int>(byKey.size()); }
+
+    bool contains(const std::string &id) const { return byId.count(id) != 0; }
+
+    int keyOf(const std::string &id) const { return byId.at(id)->first; }
+
+    int minKey() const { return byKey.begin()->first; }
+
+    void insert(const std::string &id, int key) { byId[id] = byKey.emplace(key, id); }
+
+    void setKey(const std::string &id, int key) {
+        remove(id);
+        insert(id, key);
+    }
+
+    void remove(const std::string &id) {
+        auto found = byId.find(id);
+        byKey.erase(found->second);
+        byId.erase(found);
+    }
+
+    void clear() {
+        byKey.clear();
+        byId.clear();
+    }
+
+  private:
+    std::multimap<int, std::string> byKey;
+    std::map<std::string, std::multimap<int, std::string>::iterator> byId;
+};
+
+static bool failed = false;
+
+// Report the first mismatch
+static void fail(const std::string &what) {
+    if (!failed) {
+        std::cerr << "mismatch: " << what << std::endl;
+    }
+    failed = true;
+}
+
+static std::string idOf(int i) {
+    return "id" + std::to_string(i);
+}
+
+// Insert a batch of items into the reference one at a time, returning
+// what insertBatch should
+static int insertBatch(reference &ref, const std::vector<heap<int>::item> &items) {
+    int result = 0;
+    for (const auto &it : items) {
+        int retVal = ref.size() == CAPACITY ? 1 : ref.contains(it.id) ? 2 : 0;
+        if (retVal == 0) {
+            ref.insert(it.id, it.key);
+        } else if (result == 0) {
+            result = retVal;
+        }
+    }
+    return result;
+}
+
+// Set the keys of a batch of items in the reference one at a time,
+// returning what setKeyBatch should
+static int setKeyBatch(reference &ref, const std::vector<heap<int>::item> &items) {
+    int result = 0;
+    for (const auto &it : items) {
+        if (ref.contains(it.id)) {
+            ref.setKey(it.id, it.key);
+        } else {
+            result = 1;
+        }
+    }
+    return result;
+}
+
+// Run random operations on the heap, checking each against the reference
+static void runOps(heap<int> &h, reference &ref, int ops, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> pickId(0, NUM_IDS - 1), pickKey(0, KEY_RANGE - 1), pickOp(0, 99);
+    std::uniform_int_distribution<int> pickSmall(1, 20), pickLarge(1, CAPACITY + 100);
+    std::vector<heap<int>::item> items;
+    for (int i = 0; i < ops && !failed; i++) {
+        int op = pickOp(rng);
+        std::string id = idOf(pickId(rng));
+        int key = pickKey(rng);
+        if (op >= 97) {
+            // Batches are rarer, as each is many operations, and most are small
+            items.resize(key % 4 == 0 ? pickLarge(rng) : pickSmall(rng));
+            for (auto &it : items) {
+                it.id = idOf(pickId(rng));
+                it.key = pickKey(rng);
+            }
+            int result, expected;
+            std::string name;
+            if (op == 97) {
+                name = "insertBatch";
+                result = h.insertBatch(items);
+                expected = insertBatch(ref, items);
+            } else if (op == 98) {
+                name = "setKeyBatch";
+                result = h.setKeyBatch(items);
+                expected = setKeyBatch(ref, items);
+            } else {
+                name = "buildFrom";
+                result = h.buildFrom(items);
+                ref.clear();
+                expected = insertBatch(ref, items);
+            }
+            if (result != expected) {
+                fail(name + " of " + std::to_string(items.size()) + " items returned " + std::to_string(result));
+            }
+        } else if (op < 40) {
+            int expected = ref.size() == CAPACITY ? 1 : ref.contains(id) ? 2 : 0;
+            int result = h.insert(id, key);
+            if (result != expected) {
+                fail("insert of " + id + " returned " + std::to_string(result));
+            }
+            if (result == 0) {
+                ref.insert(id, key);
+            }
+        } else if (op < 60) {
+            int result = h.setKey(id, key);
+            if (result != (ref.contains(id) ? 0 : 1)) {
+                fail("setKey of " + id + " returned " + std::to_string(result));
+            }
+            if (result == 0) {
+                ref.setKey(id, key);
+            }
+        } else if (op < 75) {
+            int oldKey = -1;
+            int result = h.remove(id, &oldKey);
+            if (result != (ref.contains(id) ? 0 : 1)) {
+                fail("remove of " + id + " returned " + std::to_string(result));
+            } else if (result == 0) {
+                if (oldKey != ref.keyOf(id)) {
+                    fail("remove of " + id + " gave key " + std::to_string(oldKey));
+                }
+                ref.remove(id);
+            }
+        } else {
+            std::string minId;
+            int minKey = -1;
+            int result = h.deleteMin(&minId, &minKey);
+            if (result != (ref.size() == 0 ? 1 : 0)) {
+                fail("deleteMin returned " + std::to_string(result));
+            } else if (result == 0) {
+                if (minKey != ref.minKey() || !ref.contains(minId) || ref.keyOf(minId) != minKey) {
+                    fail("deleteMin gave " + minId + " with key " + std::to_string(minKey));
+                } else {
+                    ref.remove(minId);
+                }
+            }
+        }
+        if (!failed && h.getSize() != ref.size()) {
+            fail("size " + std::to_string(h.getSize()) + " is not " + std::to_string(ref.size()));
+        }
+    }
+}
+
+// Delete every node in key order, checking each against the reference
+static void drain(heap<int> &h, reference &ref) {
+    std::string minId;
+    int minKey;
+    while (!failed && ref.size() > 0) {
+        if (h.deleteMin(&minId, &minKey) != 0 || minKey != ref.minKey() || !ref.contains(minId)
+            || ref.keyOf(minId) != minKey) {
+            fail("draining gave " + minId + " with key " + std::to_string(minKey));
+            return;
+        }
+        ref.remove(minId);
+    }
+    if (!failed && h.deleteMin() != 1) {
+        fail("heap not empty after draining");
+    }
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 200;
+    std::mt19937 rng(4321);
+    for (int arity : {2, 4, 8}) {
+        for (int round = 0; round < rounds && !failed; round++) {
+            heap<int> h(CAPACITY, arity);
+            reference ref;
+            runOps(h, ref, 2000, rng);
+
+            // A copy starts with the same nodes, then goes its own way
+            heap<int> copy(h);
+            reference copyRef(ref);
+            runOps(copy, copyRef, 1000, rng);
+
+            // So does a heap assigned over one already in use
+            heap<int> assigned(CAPACITY, arity);
+            reference oldRef;
+            runOps(assigned, oldRef, 300, rng);
+            assigned = h;
+            reference assignedRef(ref);
+            runOps(assigned, assignedRef, 1000, rng);
+
+            // Assigning a heap to itself leaves it as it was
+            heap<int> &self = h;
+            h = self;
+
+            runOps(h, ref, 1000, rng);
+            drain(h, ref);
+            drain(copy, copyRef);
+            drain(assigned, assignedRef);
+        }
+    }
+    if (failed) {
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include "inputReader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Whitespace as isspace sees it in the C locale
+static bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Open the file and read from its descriptor
+bool inputReader::open(const std::string &file) {
+    close();
+    int descriptor = ::open(file.c_str(), O_RDONLY);
+    return descriptor != -1 && open(descriptor);
+}
+
+// Map a regular file, or prepare to stream anything else
+bool inputReader::open(int descriptor) {
+    close();
+    if (descriptor == -1) {
+        return false;
+    }
+    fd = descriptor;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+        && st.st_size > 0 && static_cast<unsigned long long>(st.st_size) <= MAX_MAP_SIZE) {
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            // The file is read front to back, so the kernel can read ahead
+            madvise(p, st.st_size, MADV_SEQUENTIAL);
+            mapped = true;
+            data = static_cast<const char *>(p);
+            length = st.st_size;
+            // The mapping keeps the file alive, so the descriptor can go
+            ::close(fd);
+            fd = -1;
+            return true;
+        }
+    }
+    // Fall back to reading the file in blocks
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    buffer.resize(BLOCK_SIZE);
+    data = buffer.data();
+    return true;
+}
+
+void inputReader::close() {
+    if (mapped) {
+        munmap(const_cast<char *>(data), length);
+    }
+    if (fd != -1) {
+        ::close(fd);
+    }
+    fd = -1;
+    mapped = false;
+    atEnd = false;
+    data = nullptr;
+    pos = 0;
+    length = 0;
+    std::vector<char>().swap(buffer);
+}
+
+inputReader::~inputReader() {
+    close();
+}
+
+// Compact the buffer and fill the free space after the unread bytes
+bool inputReader::readMore() {
+    if (fd == -1 || atEnd) {
+        return false;
+    }
+    if (pos > 0) {
+        memmove(buffer.data(), buffer.data() + pos, length - pos);
+        length -= pos;
+        pos = 0;
+    }
+    // A full buffer means a line or field longer than the buffer
+    if (length == buffer.size()) {
+        buffer.resize(buffer.size() * 2);
+    }
+    data = buffer.data();
+    ssize_t n;
+    do {
+        n = ::read(fd, buffer.data() + length, buffer.size() - length);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        atEnd = true;
+        return false;
+    }
+    length += n;
+    return true;
+}
+
+// Scan for a newline, reading more input until one turns up
+size_t inputReader::findLineEnd(size_t skip) {
+    while (true) {
+        const void *newline = memchr(data + pos + skip, '\n', length - pos - skip);
+        if (newline) {
+            return static_cast<const char *>(newline) - data + 1;
+        }
+        // readMore moves pos, so keep the scanned length relative to it
+        skip = length - pos;
+        if (!readMore()) {
+            return length;
+        }
+    }
+}
+
+// Return the next line without its newline
+bool inputReader::getLine(std::string_view &line) {
+    while (pos == length) {
+        if (!readMore()) {
+            return false;
+        }
+    }
+    size_t end = findLineEnd(0);
+    size_t lineLength = end - pos;
+    if (data[end - 1] == '\n') {
+        lineLength--;
+    }
+    line = std::string_view(data + pos, lineLength);
+    pos = end;
+    return true;
+}
+
+// Return a block of whole lines
+bool inputReader::getLines(std::string_view &lines, size_t maxBytes) {
+    while (length - pos < maxBytes && readMore()) {
+    }
+    if (pos == length) {
+        return false;
+    }
+    size_t end = std::min(pos + maxBytes, length);
+    // Unless the block reaches the end of the file, end it after its last newline
+    if (end < length || !(mapped || atEnd)) {
+        const void *newline = memrchr(data + pos, '\n', end - pos);
+        if (newline) {
+            end = static_cast<const char *>(newline) - data + 1;
+        } else {
+            // The first line alone is longer than maxBytes
+            end = findLineEnd(end - pos);
+        }
+    }
+    lines = std::string_view(data + pos, end - pos);
+    pos = end;
+    return true;
+}
+
+// Read one field
+bool inputReader::getField(std::string_view &field) {
+    return getFields(&field, 1);
+}
+
+// Bring every field into memory first, then take views of them
+bool inputReader::getFields(std::string_view *fields, int count) {
+    // The scanned length is kept relative to pos, which readMore moves.
+    // pos itself stays put until the end, so readMore keeps every field
+    // scanned so far in the buffer.
+    size_t scan = 0;
+    for (int i = 0; i < count; i++) {
+        // Skip the whitespace before the field
+        while (true) {
+            while (pos + scan < length && isSpace(data[pos + scan])) {
+                scan++;
+            }
+            if (pos + scan < length) {
+                break;
+            }
+            if (!readMore()) {
+                pos = length;
+                return false;
+            }
+        }
+        // Find the whitespace after it
+        while (true) {
+            while (pos + scan < length && !isSpace(data[pos + scan])) {
+                scan++;
+            }
+            if (pos + scan < length || !readMore()) {
+                break;
+            }
+        }
+    }
+    const char *p = data + pos;
+    for (int i = 0; i < count; i++) {
+        while (isSpace(*p)) {
+            p++;
+        }
+        const char *start = p;
+        while (p < data + pos + scan && !isSpace(*p)) {
+            p++;
+        }
+        fields[i] = std::string_view(start, p - start);
+    }
+    pos += scan;
+    return true;
+}
@@ -0,0 +1,110 @@
+#include "outputBuffer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+outputBuffer::outputBuffer(size_t bufferSize) : bufferSize(std::max<size_t>(bufferSize, 64)) {}
+
+// Flush whatever is left before the file goes away
+outputBuffer::~outputBuffer() {
+    close();
+}
+
+// Open the file, truncating it like std::ofstream does
+bool outputBuffer::open(const std::string &file) {
+    close();
+    fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ok = (fd != -1);
+    used = 0;
+    if (ok) {
+        buffer.resize(bufferSize);
+    }
+    return ok;
+}
+
+// Flush the buffer and release the file
+bool outputBuffer::close() {
+    if (fd == -1) {
+        return ok;
+    }
+    flush();
+    ::close(fd);
+    fd = -1;
+    used = 0;
+    return ok;
+}
+
+// Hand the buffered text to the kernel in one call
+bool outputBuffer::flush() {
+    if (fd == -1 || used == 0) {
+        return ok;
+    }
+    struct iovec iov = {buffer.data(), used};
+    writeAll(&iov, 1);
+    used = 0;
+    return ok;
+}
+
+// Copy small pieces into the buffer; send large ones along with it
+void outputBuffer::write(const char *data, size_t length) {
+    if (!ok) {
+        return;
+    }
+    if (fd != -1 && length >= buffer.size()) {
+        // One writev covers the buffered text and the piece itself
+        struct iovec iov[2] = {{buffer.data(), used}, {const_cast<char *>(data), length}};
+        writeAll(used ? iov : iov + 1, used ? 2 : 1);
+        used = 0;
+        return;
+    }
+    memcpy(reserve(length), data, length);
+    used += length;
+}
+
+// Make room for n more bytes
+char *outputBuffer::reserve(size_t n) {
+    if (!ok) {
+        // Output to a file that failed is discarded
+        used = 0;
+    }
+    if (used + n > buffer.size()) {
+        if (fd != -1) {
+            flush();
+        }
+        // In memory the buffer grows; a file's buffer only grows if a
+        // single number does not fit in it
+        if (used + n > buffer.size()) {
+            buffer.resize(std::max(used + n, std::max<size_t>(2 * buffer.size(), 256)));
+        }
+    }
+    return buffer.data() + used;
+}
+
+// Keep writing until every piece is out or a write fails
+bool outputBuffer::writeAll(struct iovec *iov, int count) {
+    while (count > 0 && ok) {
+        ssize_t written = ::writev(fd, iov, count);
+        calls++;
+        if (written < 0) {
+            if (errno != EINTR) {
+                ok = false;
+            }
+            continue;
+        }
+        // Skip the pieces that were written completely
+        while (count > 0 && static_cast<size_t>(written) >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+    return ok;
+}
@@ -1,13 +1,17 @@
 #include <iostream>
 #include <fstream>
 #include <cstring>
+#include <string_view>
+#include "inputReader.h"
 
 // Global matrix for dynamic programming
 bool dp[1001][1001];
 
 int main() {
-    std::string inputFile, outputFile, A, B, C;
-    std::ifstream readInput;
+    std::string inputFile, outputFile, C;
+    // A and B are views into the mapped input; only C is copied, to be capitalized
+    std::string_view fields[3];
+    inputReader readInput;
     std::ofstream readOutput;
 
     std::cout << "Enter name of input file: ";
@@ -15,10 +19,12 @@ int main() {
     std::cout << "Enter name of output file: ";
     std::cin >> outputFile;
 
-    readInput.open(inputFile.c_str());
+    readInput.open(inputFile);
     readOutput.open(outputFile.c_str());
 
-    while (readInput >> A && readInput >> B && readInput >> C) {
+    while (readInput.getFields(fields, 3)) {
+        std::string_view A = fields[0], B = fields[1];
+        C.assign(fields[2].data(), fields[2].size());
         // Length of A+B should match the length of C
         if ((A.length() + B.length()) != C.length()) {
             readOutput << "*** NOT A MERGE ***" << std::endl;